@@ -0,0 +1,288 @@
+/**
+ * @file
+ * A small benchmark harness in the spirit of Google
+ * Benchmark. Include it from a bench-*.cpp file, define
+ * benchmarks with BENCH or BENCH_ARGS and loop on
+ * state.keep_running().
+ *
+ * Usage: .bench-foo [filter] [--json file] [--label text]
+ * [--min-time seconds]
+ *
+ * Only benchmarks whose name contains filter run. --json
+ * writes the results in Google Benchmark's JSON layout so
+ * runs from different commits can be compared with the
+ * usual tools; --label is recorded in the JSON context.
+ *
+ * @license This software is released under the Boost
+ * Software License, version 1.0.
+ * See LICENSE_1_0.txt or
+ * http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Handed to each benchmark. The benchmark body runs once per
+ * call to keep_running() that returns true.
+ */
+struct bench_state_t
+{
+   bench_state_t(std::size_t iterations, long arg)
+      :iterations_(iterations)
+      ,remaining_(iterations)
+      ,arg_(arg)
+   {
+   }
+
+   bool keep_running()
+   {
+      if (remaining_ == 0)
+      {
+         return false;
+      }
+      --remaining_;
+      return true;
+   }
+
+   std::size_t iterations() const
+   {
+      return iterations_;
+   }
+
+   /**
+    * @return the argument a BENCH_ARGS benchmark runs with.
+    */
+   long arg() const
+   {
+      return arg_;
+   }
+
+   /**
+    * Record a total for the run. It is reported divided by
+    * the number of iterations.
+    */
+   void counter(const std::string& name, double total)
+   {
+      for (auto& c : counters_)
+      {
+         if (c.first == name)
+         {
+            c.second = total;
+            return;
+         }
+      }
+      counters_.emplace_back(name, total);
+   }
+
+   const std::vector<std::pair<std::string, double>>& counters() const
+   {
+      return counters_;
+   }
+
+private:
+   std::size_t iterations_;
+   std::size_t remaining_;
+   long arg_;
+   std::vector<std::pair<std::string, double>> counters_;
+};
+
+using bench_fn_t = void (*)(bench_state_t&);
+
+struct bench_t
+{
+   std::string name;
+   bench_fn_t fn;
+   long arg;
+};
+
+inline std::vector<bench_t>& benchmarks()
+{
+   static std::vector<bench_t> result;
+   return result;
+}
+
+struct bench_registrar_t
+{
+   bench_registrar_t(const char* name, bench_fn_t fn)
+   {
+      benchmarks().push_back({name, fn, 0});
+   }
+
+   bench_registrar_t
+   (
+      const char* name,
+      bench_fn_t fn,
+      std::initializer_list<long> args
+   )
+   {
+      for (long arg : args)
+      {
+         benchmarks().push_back({name + ("/" + std::to_string(arg)), fn, arg});
+      }
+   }
+};
+
+/**
+ * Keep the compiler from discarding a computation whose
+ * result is otherwise unused.
+ */
+template <typename value_t>
+inline void do_not_optimize(const value_t& value)
+{
+   asm volatile("" : : "r"(&value) : "memory");
+}
+
+#define BENCH(name)\
+   static void name(bench_state_t& state);\
+   static bench_registrar_t name ## _registrar(#name, name);\
+   static void name(bench_state_t& state)
+
+/**
+ * A benchmark that runs once per argument, reported as
+ * name/arg.
+ */
+#define BENCH_ARGS(name, ...)\
+   static void name(bench_state_t& state);\
+   static bench_registrar_t name ## _registrar(#name, name, {__VA_ARGS__});\
+   static void name(bench_state_t& state)
+
+/**
+ * Runs the selected benchmarks, growing the iteration count
+ * until a run takes long enough to time reliably.
+ */
+int main(int argc, char** argv)
+{
+   using steady_t = std::chrono::steady_clock;
+   double min_seconds = 0.2;
+   const char* filter = "";
+   const char* json_path = nullptr;
+   const char* label = "";
+   for (int i = 1; i < argc; ++i)
+   {
+      if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+      {
+         json_path = argv[++i];
+      }
+      else if (std::strcmp(argv[i], "--label") == 0 && i + 1 < argc)
+      {
+         label = argv[++i];
+      }
+      else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+      {
+         min_seconds = std::atof(argv[++i]);
+      }
+      else
+      {
+         filter = argv[i];
+      }
+   }
+
+   FILE* json = nullptr;
+   if (json_path)
+   {
+      json = std::fopen(json_path, "w");
+      if (!json)
+      {
+         std::perror(json_path);
+         return 1;
+      }
+      char date[32];
+      std::time_t now = std::time(nullptr);
+      std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+      std::fprintf
+      (
+         json,
+         "{\n"
+         "  \"context\": {\n"
+         "    \"date\": \"%s\",\n"
+         "    \"executable\": \"%s\",\n"
+         "    \"label\": \"%s\"\n"
+         "  },\n"
+         "  \"benchmarks\": [",
+         date,
+         argv[0],
+         label
+      );
+   }
+
+   const char* separator = "\n";
+   for (auto& b : benchmarks())
+   {
+      if (b.name.find(filter) == std::string::npos)
+      {
+         continue;
+      }
+
+      std::size_t iterations = 1;
+      while (true)
+      {
+         bench_state_t state(iterations, b.arg);
+         auto start = steady_t::now();
+         b.fn(state);
+         double seconds =
+            std::chrono::duration<double>(steady_t::now() - start).count();
+
+         if (seconds >= min_seconds || iterations >= 1000000000)
+         {
+            double ns = seconds * 1e9 / iterations;
+            std::printf("%-40s %12zu %14.1f ns", b.name.c_str(), iterations, ns);
+            if (json)
+            {
+               std::fprintf
+               (
+                  json,
+                  "%s    {\n"
+                  "      \"name\": \"%s\",\n"
+                  "      \"iterations\": %zu,\n"
+                  "      \"real_time\": %.3f,\n"
+                  "      \"time_unit\": \"ns\"",
+                  separator,
+                  b.name.c_str(),
+                  iterations,
+                  ns
+               );
+               separator = ",\n";
+            }
+            for (auto& c : state.counters())
+            {
+               std::printf(" %s=%g", c.first.c_str(), c.second / iterations);
+               if (json)
+               {
+                  std::fprintf
+                  (
+                     json,
+                     ",\n      \"%s\": %g",
+                     c.first.c_str(),
+                     c.second / iterations
+                  );
+               }
+            }
+            std::printf("\n");
+            std::fflush(stdout);
+            if (json)
+            {
+               std::fprintf(json, "\n    }");
+            }
+            break;
+         }
+         iterations *= seconds > 0 && seconds * 100 < min_seconds ? 10 : 2;
+      }
+   }
+
+   if (json)
+   {
+      std::fprintf(json, "\n  ]\n}\n");
+      std::fclose(json);
+   }
+   return 0;
+}
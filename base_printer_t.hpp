@@ -1,71 +1,237 @@
 #ifndef __base_t_hpp__
 #define __base_t_hpp__
 
+#include <climits>
+#include <cstddef>
+#include <ios>
+#include <limits>
 #include <string>
-#include <sstream>
-#include <iosfwd>
-#include <stack>
-#include <unordered_map>
+#include <boost/math/special_functions/fpclassify.hpp>
 #include "num_t.hpp"
+#include "num_traits_t.hpp"
 
+/**
+ * Prints numbers in a power of two base. The value is split
+ * into two int_t: the integer part, and the fraction scaled
+ * up by a power of the base. Digits are then read straight
+ * out of their limbs through a lookup table into a buffer of
+ * the right size. The fraction gets as many digits as
+ * number_t has precision left after the integer part, with
+ * trailing zeros dropped.
+ */
 struct base_printer_t
 {
+   /**
+    * @param[in] bits how many bits make up one digit: 1, 3
+    * or 4
+    * @param[in] prefix written between the sign and the
+    * digits
+    */
+   template <typename number_t>
    std::string convert
    (
-      const num_t& n,
-      const std::unordered_map<int, char>& digits,
-      const std::string& prefix
-   )
+      const number_t& n,
+      unsigned bits,
+      const char* prefix
+   ) const
    {
-      if (n < 1)
+      if constexpr (!std::numeric_limits<number_t>::is_integer)
       {
-         std::string result = prefix + "0";
-         return result;
+         if (!boost::math::isfinite(n))
+         {
+            return num_traits_t<number_t>::str(n);
+         }
       }
 
-      const std::size_t num_digits = digits.size();
-      const std::size_t mask = num_digits - 1;
-      std::size_t shift_amount = 0;
-      std::size_t mask_copy = mask;
-      while (mask_copy)
+      const bool negative = n < 0;
+      parts_t parts = split(negative ? number_t(-n) : n, bits);
+      std::size_t whole_digits = 1;
+      if (parts.whole != 0)
       {
-         ++shift_amount;
-         mask_copy >>= 1;
+         whole_digits = msb(parts.whole) / bits + 1;
       }
-      try
+
+      std::string result;
+      result.reserve(1 + 2 + whole_digits + 1 + parts.fraction_digits);
+      if (negative && (parts.whole != 0 || parts.fraction_digits != 0))
       {
+         result += '-';
+      }
+      result += prefix;
+      append_digits(result, parts.whole, bits, whole_digits);
+      if (parts.fraction_digits != 0)
+      {
+         result += '.';
+         append_digits(result, parts.fraction, bits, parts.fraction_digits);
+         result.erase(result.find_last_not_of('0') + 1);
+      }
+      return result;
+   }
+
+private:
+   /**
+    * A non-negative number as whole + fraction /
+    * 2^(fraction_digits * bits).
+    */
+   struct parts_t
+   {
+      int_t whole;
+      int_t fraction;
+      std::size_t fraction_digits = 0;
+   };
 
-         int_t whole(floor(n).str());
-         std::stack<char> s;
-         while (whole > 0)
+   template <typename number_t>
+   static parts_t split(const number_t& magnitude, unsigned bits)
+   {
+      parts_t parts;
+      if constexpr (std::numeric_limits<number_t>::is_integer)
+      {
+         parts.whole = magnitude;
+      }
+      else if constexpr (std::numeric_limits<number_t>::radix == 10)
+      {
+         // Boost converts a decimal float to cpp_int a piece
+         // at a time, taking milliseconds at 1024 digits, and
+         // scaling one by a large power of two is nearly as
+         // slow. Both parts come out of the fixed point text
+         // in microseconds instead.
+         std::string text = magnitude.str(0, std::ios_base::fixed);
+         const std::size_t point = text.find('.');
+         if (point == std::string::npos)
          {
-            int digit = static_cast<int>(whole & mask);
-            auto p = digits.find(digit);
-            if (p == digits.end())
-            {
-               throw "missing digits";
-            }
-            s.push(p->second);
-            whole >>= shift_amount;
+            parts.whole = int_t(text);
+            return parts;
+         }
+         parts.whole = int_t(text.substr(0, point));
+         text.erase(0, point + 1);
+         text.erase(text.find_last_not_of('0') + 1);
+         if (text.empty())
+         {
+            return parts;
+         }
+         // Each leading zero of the fraction is about log2(10)
+         // bits that carry no precision.
+         const long leading_zero_bits =
+            static_cast<long>(text.find_first_not_of('0')) * 33220L / 10000;
+         const long fraction_bits =
+            precision_bits<number_t>() - whole_bits(parts.whole) + leading_zero_bits;
+         if (fraction_bits <= 0)
+         {
+            return parts;
+         }
+         parts.fraction_digits = (fraction_bits + bits - 1) / bits;
+         const std::size_t scale = parts.fraction_digits * bits;
+         const int_t denominator =
+            boost::multiprecision::pow(int_t(10), static_cast<unsigned>(text.size()));
+         int_t remainder;
+         divide_qr(int_t(text) << scale, denominator, parts.fraction, remainder);
+         if (remainder * 2 >= denominator)
+         {
+            ++parts.fraction;
+         }
+         carry(parts, scale);
+      }
+      else
+      {
+         const number_t floored = floor(magnitude);
+         parts.whole = static_cast<int_t>(floored);
+         const number_t fraction = magnitude - floored;
+         if (fraction == 0)
+         {
+            return parts;
          }
-         std::stringstream ss;
-         ss << prefix;
-         while (!s.empty())
+         int exponent = 0;
+         frexp(fraction, &exponent);
+         const long fraction_bits =
+            precision_bits<number_t>() - whole_bits(parts.whole) - exponent;
+         if (fraction_bits <= 0)
          {
-            ss << s.top();
-            s.pop();
+            return parts;
          }
-         std::string result = ss.str();
+         parts.fraction_digits = (fraction_bits + bits - 1) / bits;
+         const std::size_t scale = parts.fraction_digits * bits;
+         parts.fraction =
+            static_cast<int_t>(round(ldexp(fraction, static_cast<int>(scale))));
+         carry(parts, scale);
+      }
+      return parts;
+   }
 
-         return result;
+   /**
+    * Move a fraction that rounded up to 1 into the whole.
+    */
+   static void carry(parts_t& parts, std::size_t scale)
+   {
+      if (parts.fraction != 0 && msb(parts.fraction) >= scale)
+      {
+         ++parts.whole;
+         parts.fraction = 0;
       }
-      catch (const std::exception& e)
+      if (parts.fraction == 0)
       {
-         // can't convert to int, print normally
+         parts.fraction_digits = 0;
       }
+   }
 
-      std::string result = n.str();
-      return result;
+   static long whole_bits(const int_t& whole)
+   {
+      return whole == 0 ? 0 : static_cast<long>(msb(whole)) + 1;
+   }
+
+   /**
+    * @return about how many bits of precision number_t has.
+    */
+   template <typename number_t>
+   static constexpr long precision_bits()
+   {
+      using limits = std::numeric_limits<number_t>;
+      if (limits::radix == 2)
+      {
+         return limits::digits;
+      }
+      // log2(10) is a little over 3.3219.
+      return limits::digits10 * 33220L / 10000 + 1;
+   }
+
+   /**
+    * Append the low count digits of a non-negative value,
+    * most significant first.
+    */
+   static void append_digits
+   (
+      std::string& out,
+      const int_t& value,
+      unsigned bits,
+      std::size_t count
+   )
+   {
+      using limb_type = boost::multiprecision::limb_type;
+      constexpr unsigned limb_bits = sizeof(limb_type) * CHAR_BIT;
+      static constexpr char digit_chars[] = "0123456789abcdef";
+
+      const limb_type* limbs = value.backend().limbs();
+      const std::size_t size = value.backend().size();
+      const limb_type mask = (limb_type(1) << bits) - 1;
+
+      const std::size_t start = out.size();
+      out.resize(start + count);
+      char* last = &out[start + count - 1];
+      for (std::size_t i = 0; i < count; ++i)
+      {
+         const std::size_t bit = i * bits;
+         const std::size_t limb = bit / limb_bits;
+         const unsigned offset = bit % limb_bits;
+         limb_type digit = 0;
+         if (limb < size)
+         {
+            digit = limbs[limb] >> offset;
+            if (offset + bits > limb_bits && limb + 1 < size)
+            {
+               digit |= limbs[limb + 1] << (limb_bits - offset);
+            }
+         }
+         *(last - i) = digit_chars[digit & mask];
+      }
    }
 };
 
@@ -0,0 +1,155 @@
+#ifndef __batch_t_hpp__
+#define __batch_t_hpp__
+
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include "budget_t.hpp"
+#include "debug.hpp"
+#include "num_t.hpp"
+#include "num_traits_t.hpp"
+#include "postfix_t.hpp"
+#include "program_t.hpp"
+
+/**
+ * Streams records through one compiled program. Each input
+ * line is a record whose fields are bound, in order, to the
+ * program's named inputs. A program without inputs ignores
+ * the fields and gives the same result for every record.
+ * Each record produces one line of output holding the top of
+ * the stack, so output lines match input lines: a blank line
+ * or a record that fails gives an empty one.
+ */
+template <typename number_t>
+struct basic_batch_t
+{
+   using postfix_type = basic_postfix_t<number_t>;
+   using program_type = basic_program_t<number_t>;
+
+   /**
+    * @param[in] program the expression to evaluate per
+    * record, which the batch keeps its own copy of
+    * @param[in] csv true when fields are comma separated,
+    * false when they are separated by whitespace
+    */
+   basic_batch_t(const program_type& program, bool csv)
+      :program_(program)
+      ,csv_(csv)
+   {
+   }
+
+   /**
+    * The limits on each record. A record that exceeds them
+    * fails like any other.
+    */
+   budget_t& budget()
+   {
+      return budget_;
+   }
+
+   /**
+    * Evaluate every record in an input stream.
+    * @param[in] in the records, one per line
+    * @param[in] out receives one result per record
+    * @param[in] err receives a description of each record
+    * that could not be evaluated
+    * @return the number of records that failed
+    */
+   std::size_t run(std::istream& in, std::ostream& out, std::ostream& err)
+   {
+      std::size_t failures = 0;
+      std::size_t row = 0;
+      std::string line;
+      std::vector<std::string> fields;
+      std::vector<number_t> inputs;
+      std::vector<number_t> slots;
+      postfix_type p;
+      p.budget() = budget_;
+      while (std::getline(in, line))
+      {
+         ++row;
+         boost::trim(line);
+         if (line.empty())
+         {
+            out << '\n';
+            continue;
+         }
+
+         try
+         {
+            inputs.clear();
+            if (!program_.inputs().empty())
+            {
+               split(line, fields);
+               ensure(fields.size() == program_.inputs().size());
+               for (const std::string& field : fields)
+               {
+                  inputs.push_back(postfix_type::parse(field));
+               }
+            }
+            p.clear();
+            program_.run(p, inputs, slots);
+            out << num_traits_t<number_t>::str(p.top()) << '\n';
+         }
+         catch (const char* e)
+         {
+            fail(row, e, out, err, failures);
+         }
+         // Running out of memory, say, fails only the record.
+         catch (const std::exception& e)
+         {
+            fail(row, e.what(), out, err, failures);
+         }
+      }
+      out.flush();
+      return failures;
+   }
+
+private:
+   static void fail
+   (
+      std::size_t row,
+      const char* e,
+      std::ostream& out,
+      std::ostream& err,
+      std::size_t& failures
+   )
+   {
+      ++failures;
+      out << '\n';
+      err << "row " << row << ": " << e << '\n';
+   }
+
+   void split(const std::string& line, std::vector<std::string>& fields)
+   {
+      fields.clear();
+      if (csv_)
+      {
+         boost::split(fields, line, boost::is_any_of(","));
+         for (std::string& field : fields)
+         {
+            boost::trim(field);
+         }
+      }
+      else
+      {
+         boost::split
+         (
+            fields,
+            line,
+            boost::is_space(),
+            boost::token_compress_on
+         );
+      }
+   }
+
+   program_type program_;
+   bool csv_;
+   budget_t budget_;
+};
+
+using batch_t = basic_batch_t<num_t>;
+
+#endif
@@ -0,0 +1,119 @@
+#include ".bench.hpp"
+#include "infix_t.hpp"
+#include "compiler_t.hpp"
+#include "optimizer_t.hpp"
+
+namespace
+{
+   /**
+    * @return ((1+1)+1)... nested depth levels deep.
+    */
+   std::string nested(long depth)
+   {
+      std::string result = "1";
+      for (long i = 0; i < depth; ++i)
+      {
+         result = "(" + result + "+1)";
+      }
+      return result;
+   }
+
+   /**
+    * @return 1+1*1-1/1+... with count operators.
+    */
+   std::string flat(long count)
+   {
+      const char ops[] = "+*-/";
+      std::string result = "1";
+      for (long i = 0; i < count; ++i)
+      {
+         result += ops[i % 4];
+         result += "1";
+      }
+      return result;
+   }
+}
+
+BENCH_ARGS(parse_nested, 1, 8, 64)
+{
+   const std::string expr = nested(state.arg());
+   postfix_t p;
+   infix_t infix(p);
+   while (state.keep_running())
+   {
+      infix.parse(expr);
+      p.clear();
+   }
+   do_not_optimize(p);
+}
+
+BENCH_ARGS(parse_flat, 1, 8, 64)
+{
+   const std::string expr = flat(state.arg());
+   postfix_t p;
+   infix_t infix(p);
+   while (state.keep_running())
+   {
+      infix.parse(expr);
+      p.clear();
+   }
+   do_not_optimize(p);
+}
+
+BENCH_ARGS(compile_nested, 1, 8, 64)
+{
+   const std::string expr = nested(state.arg());
+   compiler_t compiler;
+   std::size_t size = 0;
+   while (state.keep_running())
+   {
+      size += compiler.infix(expr).size();
+   }
+   do_not_optimize(size);
+}
+
+BENCH_ARGS(run_compiled_nested, 1, 8, 64)
+{
+   compiler_t compiler;
+   program_t program = compiler.infix(nested(state.arg()));
+   postfix_t p;
+   while (state.keep_running())
+   {
+      program.run(p);
+      p.clear();
+   }
+   do_not_optimize(p);
+}
+
+BENCH_ARGS(run_compiled_flat, 1, 8, 64)
+{
+   compiler_t compiler;
+   program_t program = compiler.infix(flat(state.arg()));
+   postfix_t p;
+   while (state.keep_running())
+   {
+      program.run(p);
+      p.clear();
+   }
+   do_not_optimize(p);
+}
+
+// 0 runs the formula as compiled, 1 optimized.
+BENCH_ARGS(run_formula, 0, 1)
+{
+   compiler_t compiler;
+   program_t program = compiler.infix("(x+1)*(x+1) + 2*pi*(x+1) + 2^0.5*x^2", {"x"});
+   if (state.arg())
+   {
+      program = optimizer_t()(program);
+   }
+   const std::vector<num_t> inputs = {num_t("1.5")};
+   std::vector<num_t> slots;
+   postfix_t p;
+   while (state.keep_running())
+   {
+      program.run(p, inputs, slots);
+      p.clear();
+   }
+   do_not_optimize(p);
+}
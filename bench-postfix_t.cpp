@@ -0,0 +1,774 @@
+#include <sstream>
+#include ".bench.hpp"
+#include "postfix_t.hpp"
+#include "value_stack_t.hpp"
+#include "stack_view_t.hpp"
+#include "rat_t.hpp"
+
+namespace
+{
+   /**
+    * A num_t that counts how often it is copied and moved.
+    */
+   struct counted_t
+   {
+      static inline std::size_t copies = 0;
+      static inline std::size_t moves = 0;
+
+      counted_t() {}
+      counted_t(const num_t& n) :n_(n) {}
+      counted_t(const counted_t& rhs) :n_(rhs.n_) { ++copies; }
+      counted_t(counted_t&& rhs) :n_(std::move(rhs.n_)) { ++moves; }
+      counted_t& operator=(const counted_t& rhs)
+      {
+         n_ = rhs.n_;
+         ++copies;
+         return *this;
+      }
+      counted_t& operator=(counted_t&& rhs)
+      {
+         n_ = std::move(rhs.n_);
+         ++moves;
+         return *this;
+      }
+      counted_t& operator+=(const counted_t& rhs)
+      {
+         n_ += rhs.n_;
+         return *this;
+      }
+      friend counted_t operator+(const counted_t& lhs, const counted_t& rhs)
+      {
+         return counted_t(lhs.n_ + rhs.n_);
+      }
+
+      static void reset()
+      {
+         copies = 0;
+         moves = 0;
+      }
+
+      num_t n_;
+   };
+
+   void report(bench_state_t& state)
+   {
+      state.counter("copies", counted_t::copies);
+      state.counter("moves", counted_t::moves);
+   }
+
+   const num_t third = num_t(1) / 3;
+}
+
+// What every binary handler used to do: pop both operands,
+// compute into a temporary and push a copy of it.
+BENCH(stack_binary_pop_pop_push)
+{
+   value_stack_t<counted_t> s;
+   const counted_t operand(third);
+   s.push(operand);
+   counted_t::reset();
+   while (state.keep_running())
+   {
+      s.push(operand);
+      counted_t rhs = s.pop();
+      counted_t lhs = s.pop();
+      counted_t result = lhs + rhs;
+      s.push(result);
+   }
+   report(state);
+}
+
+BENCH(stack_binary_in_place)
+{
+   value_stack_t<counted_t> s;
+   const counted_t operand(third);
+   s.push(operand);
+   counted_t::reset();
+   while (state.keep_running())
+   {
+      s.push(operand);
+      s.top(1) += s.top();
+      s.drop();
+   }
+   report(state);
+}
+
+BENCH(postfix_add_pop_pop_push)
+{
+   postfix_t p;
+   p.push(third);
+   while (state.keep_running())
+   {
+      p.push(third);
+      num_t rhs = p.pop();
+      num_t lhs = p.pop();
+      num_t result = lhs + rhs;
+      p.push(result);
+   }
+   do_not_optimize(p);
+}
+
+BENCH(postfix_add_execute)
+{
+   postfix_t p;
+   p.push(third);
+   while (state.keep_running())
+   {
+      p.push(third);
+      p.execute(op_t::add);
+   }
+   do_not_optimize(p);
+}
+
+BENCH(postfix_sqrt_pop_push)
+{
+   postfix_t p;
+   while (state.keep_running())
+   {
+      p.push(third);
+      num_t rhs = p.pop();
+      num_t result = sqrt(rhs);
+      p.push(result);
+      p.clear();
+   }
+   do_not_optimize(p);
+}
+
+BENCH(postfix_sqrt_execute)
+{
+   postfix_t p;
+   while (state.keep_running())
+   {
+      p.push(third);
+      p.execute(op_t::sqrt);
+      p.clear();
+   }
+   do_not_optimize(p);
+}
+
+BENCH(postfix_swap_execute)
+{
+   postfix_t p;
+   p.push(third);
+   p.push(third);
+   while (state.keep_running())
+   {
+      p.execute(op_t::swap);
+   }
+   do_not_optimize(p);
+}
+
+BENCH(find_op_hit)
+{
+   const std::string names[] = {"+", "sqrt", "STDDEV", "seq1"};
+   op_t op;
+   std::size_t found = 0;
+   while (state.keep_running())
+   {
+      for (const std::string& name : names)
+      {
+         found += find_op(name, op);
+      }
+   }
+   do_not_optimize(found);
+}
+
+BENCH(find_op_miss)
+{
+   const std::string names[] = {"12345", "0xff", "1.5e10", "frobnicate"};
+   op_t op;
+   std::size_t found = 0;
+   while (state.keep_running())
+   {
+      for (const std::string& name : names)
+      {
+         found += find_op(name, op);
+      }
+   }
+   do_not_optimize(found);
+}
+
+BENCH(push_string_add)
+{
+   postfix_t p;
+   p.push(third);
+   const std::string plus = "+";
+   while (state.keep_running())
+   {
+      p.push(third);
+      p.push(plus);
+   }
+   do_not_optimize(p);
+}
+
+namespace
+{
+   void push_literal(bench_state_t& state, const std::string& literal)
+   {
+      postfix_t p;
+      while (state.keep_running())
+      {
+         p.push(literal);
+         p.clear();
+      }
+      do_not_optimize(p);
+   }
+
+   std::string digits(char digit, long count)
+   {
+      return std::string(static_cast<std::size_t>(count), digit);
+   }
+}
+
+BENCH(push_decimal_integer)
+{
+   push_literal(state, "1234567");
+}
+
+BENCH(push_decimal_fraction)
+{
+   push_literal(state, "3.14159265358979");
+}
+
+BENCH(push_decimal_commas)
+{
+   push_literal(state, "1,234,567,890");
+}
+
+BENCH(push_decimal_exponent)
+{
+   push_literal(state, "6.02214076e23");
+}
+
+BENCH_ARGS(push_decimal_digits, 8, 64, 512)
+{
+   push_literal(state, digits('7', state.arg()));
+}
+
+BENCH_ARGS(push_hexadecimal_digits, 8, 64, 256)
+{
+   push_literal(state, "0x" + digits('f', state.arg()));
+}
+
+BENCH_ARGS(push_octal_digits, 8, 64, 256)
+{
+   push_literal(state, "0o" + digits('7', state.arg()));
+}
+
+BENCH_ARGS(push_binary_digits, 8, 64, 256)
+{
+   push_literal(state, "0b" + digits('1', state.arg()));
+}
+
+BENCH(push_hexadecimal_fraction)
+{
+   push_literal(state, "0xdead.beef");
+}
+
+namespace
+{
+   /**
+    * Render a stack of 100 mixed integers and fractions.
+    */
+   void display
+   (
+      bench_state_t& state,
+      const std::string& mode,
+      std::size_t digits = 0
+   )
+   {
+      postfix_t p;
+      for (int i = 0; i < 50; ++i)
+      {
+         p.push(i * 1000003);
+         p.push(third * i);
+      }
+      p.push(mode);
+      p.display_digits(digits);
+      std::size_t length = 0;
+      while (state.keep_running())
+      {
+         length += p.str().size();
+      }
+      state.counter("bytes", length);
+   }
+}
+
+BENCH(display_dec)
+{
+   display(state, "dec");
+}
+
+BENCH(display_eng)
+{
+   display(state, "eng");
+}
+
+BENCH(display_com)
+{
+   display(state, "com");
+}
+
+BENCH_ARGS(display_dec_digits, 12, 100)
+{
+   display(state, "dec", state.arg());
+}
+
+BENCH_ARGS(display_eng_digits, 12, 100)
+{
+   display(state, "eng", state.arg());
+}
+
+BENCH(display_hex)
+{
+   display(state, "hex");
+}
+
+BENCH(display_oct)
+{
+   display(state, "oct");
+}
+
+BENCH(display_bin)
+{
+   display(state, "bin");
+}
+
+// What the prompt costs after one push onto a deep stack,
+// rendering everything as the REPL used to.
+BENCH_ARGS(prompt_full, 100, 10000)
+{
+   postfix_t p;
+   p.push(state.arg());
+   p.push("seq1");
+   std::size_t length = 0;
+   while (state.keep_running())
+   {
+      p.push(2);
+      length += p.str().size();
+      p.push("*");
+   }
+   state.counter("bytes", length);
+}
+
+BENCH_ARGS(prompt_window, 100, 10000)
+{
+   postfix_t p;
+   stack_view_t view;
+   p.push(state.arg());
+   p.push("seq1");
+   std::ostringstream o;
+   view.render(o, p);
+   std::size_t rendered = 0;
+   while (state.keep_running())
+   {
+      p.push(2);
+      o.str("");
+      view.render(o, p);
+      rendered += view.rendered();
+      p.push("*");
+   }
+   state.counter("rendered", rendered);
+}
+
+namespace
+{
+   /**
+    * Push the operands then run one operator, starting from
+    * an empty stack every iteration.
+    */
+   template <typename number_t = num_t>
+   void run_op
+   (
+      bench_state_t& state,
+      std::initializer_list<std::common_type_t<number_t>> operands,
+      op_t op
+   )
+   {
+      basic_postfix_t<number_t> p;
+      while (state.keep_running())
+      {
+         p.clear();
+         for (const number_t& operand : operands)
+         {
+            p.push(operand);
+         }
+         p.execute(op);
+      }
+      do_not_optimize(p);
+   }
+}
+
+BENCH_ARGS(shift_left, 10, 100, 1000)
+{
+   run_op(state, {third, state.arg()}, op_t::shift_left);
+}
+
+BENCH_ARGS(shift_right, 10, 100, 1000)
+{
+   run_op(state, {third, state.arg()}, op_t::shift_right);
+}
+
+BENCH_ARGS(shift_left_int, 10, 100, 1000)
+{
+   run_op<int_t>(state, {0xdeadbeef, state.arg()}, op_t::shift_left);
+}
+
+BENCH_ARGS(shift_right_int, 10, 100, 1000)
+{
+   run_op<int_t>(state, {0xdeadbeef, state.arg()}, op_t::shift_right);
+}
+
+BENCH(bit_and)
+{
+   run_op(state, {0xdeadbeef, 0xff00ff}, op_t::bit_and);
+}
+
+BENCH(bit_and_int)
+{
+   run_op<int_t>(state, {0xdeadbeef, 0xff00ff}, op_t::bit_and);
+}
+
+BENCH_ARGS(factorial, 10, 100, 1000)
+{
+   run_op(state, {state.arg()}, op_t::factorial);
+}
+
+// The operator above is answered from the cache after the
+// first iteration; this is the cost of a miss.
+BENCH_ARGS(factorial_uncached, 10, 100, 1000, 10000)
+{
+   num_t n = state.arg();
+   while (state.keep_running())
+   {
+      num_t result = factorial_t<num_t>::compute(n);
+      do_not_optimize(result);
+   }
+}
+
+BENCH(constant_e)
+{
+   run_op(state, {}, op_t::e);
+}
+
+BENCH(constant_pi)
+{
+   run_op(state, {}, op_t::pi);
+}
+
+BENCH(gam)
+{
+   run_op(state, {1000}, op_t::gam);
+}
+
+// In doubles the arithmetic is cheap and the dispatch shows.
+BENCH(gam_double)
+{
+   run_op<double>(state, {1000}, op_t::gam);
+}
+
+BENCH(past_double)
+{
+   run_op<double>(state, {140}, op_t::past);
+}
+
+BENCH(log2_double)
+{
+   run_op<double>(state, {0.3}, op_t::log2);
+}
+
+BENCH(sw)
+{
+   run_op(state, {1, 2}, op_t::sw);
+}
+
+namespace
+{
+   const char* const hypotenuse = "2 ^ sw 2 ^ + sqrt";
+}
+
+// The same steps as the tokens pushed one at a time and as a
+// call to their definition, in doubles so the dispatch shows.
+BENCH(push_definition_tokens)
+{
+   std::vector<std::string> tokens;
+   std::istringstream words(hypotenuse);
+   for (std::string word; words >> word;)
+   {
+      tokens.push_back(word);
+   }
+   basic_postfix_t<double> p;
+   while (state.keep_running())
+   {
+      p.clear();
+      p.push(3);
+      p.push(4);
+      for (const std::string& token : tokens)
+      {
+         p.push(token);
+      }
+   }
+   do_not_optimize(p);
+}
+
+BENCH(call_definition)
+{
+   basic_postfix_t<double> p;
+   p.define("hyp", hypotenuse);
+   while (state.keep_running())
+   {
+      p.clear();
+      p.push(3);
+      p.push(4);
+      p.push("hyp");
+   }
+   do_not_optimize(p);
+}
+
+namespace
+{
+   /**
+    * Run a statistics operator or a reduction over a stack of state.arg()
+    * fractions, or integers, refilled every iteration.
+    */
+   void statistics(bench_state_t& state, op_t op, bool integers = false)
+   {
+      std::vector<num_t> values;
+      for (long i = 1; i <= state.arg(); ++i)
+      {
+         values.push_back(integers ? num_t(i) : third * i);
+      }
+      postfix_t p;
+      while (state.keep_running())
+      {
+         p.clear();
+         for (const num_t& value : values)
+         {
+            p.push(value);
+         }
+         p.execute(op);
+      }
+      do_not_optimize(p);
+   }
+}
+
+BENCH_ARGS(stddev, 1000, 10000)
+{
+   statistics(state, op_t::stddev);
+}
+
+BENCH_ARGS(stats, 1000, 10000)
+{
+   statistics(state, op_t::stats);
+}
+
+BENCH_ARGS(stddev_integers, 1000, 10000)
+{
+   statistics(state, op_t::stddev, true);
+}
+
+BENCH_ARGS(sum, 1000, 10000)
+{
+   statistics(state, op_t::sum);
+}
+
+namespace
+{
+   /**
+    * Fold state.arg() doubles with threads threads, 0 for
+    * one per core, to show how the tree scales. Counts past
+    * the number of cores only measure the pool's overhead.
+    */
+   void tree_sum(bench_state_t& state, std::size_t threads)
+   {
+      std::vector<double> values;
+      for (long i = 1; i <= state.arg(); ++i)
+      {
+         values.push_back(1.0 / i);
+      }
+      budget_t budget;
+      budget_t::scope_t scope(budget);
+      tree_t<double> tree(budget, threads);
+      double total = 0;
+      while (state.keep_running())
+      {
+         total += tree
+         (
+            values.begin(),
+            values.end(),
+            [](double& lhs, double rhs)
+            {
+               lhs += rhs;
+            }
+         );
+      }
+      do_not_optimize(total);
+   }
+
+   /**
+    * prod over 1 ... state.arg() in int mode, the stack
+    * refilled every iteration.
+    */
+   void product(bench_state_t& state, std::size_t threads)
+   {
+      basic_postfix_t<int_t> p;
+      p.threads(threads);
+      while (state.keep_running())
+      {
+         p.clear();
+         for (long i = 1; i <= state.arg(); ++i)
+         {
+            p.push(int_t(i));
+         }
+         p.execute(op_t::prod);
+      }
+      do_not_optimize(p);
+   }
+}
+
+BENCH_ARGS(tree_sum_serial, 100000, 1000000, 10000000)
+{
+   tree_sum(state, 1);
+}
+
+BENCH_ARGS(tree_sum_2_threads, 100000, 1000000, 10000000)
+{
+   tree_sum(state, 2);
+}
+
+BENCH_ARGS(tree_sum_4_threads, 100000, 1000000, 10000000)
+{
+   tree_sum(state, 4);
+}
+
+BENCH_ARGS(tree_sum_8_threads, 100000, 1000000, 10000000)
+{
+   tree_sum(state, 8);
+}
+
+BENCH_ARGS(tree_sum_parallel, 100000, 1000000, 10000000)
+{
+   tree_sum(state, 0);
+}
+
+// What prod used to do.
+BENCH_ARGS(prod_int_left_fold, 10000, 100000)
+{
+   std::vector<int_t> values;
+   for (long i = 1; i <= state.arg(); ++i)
+   {
+      values.emplace_back(i);
+   }
+   while (state.keep_running())
+   {
+      int_t result = 1;
+      for (const int_t& value : values)
+      {
+         result *= value;
+      }
+      do_not_optimize(result);
+   }
+}
+
+BENCH_ARGS(prod_int_serial, 10000, 100000)
+{
+   product(state, 1);
+}
+
+BENCH_ARGS(prod_int_parallel, 10000, 100000)
+{
+   product(state, 0);
+}
+
+BENCH_ARGS(seq0, 10, 100, 1000)
+{
+   run_op(state, {state.arg()}, op_t::seq0);
+}
+
+BENCH_ARGS(seq1, 10, 100, 1000)
+{
+   run_op(state, {state.arg()}, op_t::seq1);
+}
+
+BENCH_ARGS(seq2, 10, 100, 1000)
+{
+   run_op(state, {1, state.arg()}, op_t::seq2);
+}
+
+BENCH_ARGS(seq3, 10, 100, 1000)
+{
+   run_op(state, {1, third, state.arg()}, op_t::seq3);
+}
+
+namespace
+{
+   /**
+    * state.arg() seq1 followed by op.
+    */
+   void over_sequence(bench_state_t& state, op_t op)
+   {
+      postfix_t p;
+      while (state.keep_running())
+      {
+         p.clear();
+         p.push(state.arg());
+         p.execute(op_t::seq1);
+         p.execute(op);
+      }
+      do_not_optimize(p);
+   }
+}
+
+BENCH_ARGS(seq1_sum, 1000, 100000, 10000000)
+{
+   over_sequence(state, op_t::sum);
+}
+
+// neg can't work on a pending sequence, so this pushes every
+// value first.
+BENCH_ARGS(seq1_neg, 1000, 100000)
+{
+   over_sequence(state, op_t::neg);
+}
+
+BENCH_ARGS(seq1_stats, 1000, 100000)
+{
+   over_sequence(state, op_t::stats);
+}
+
+namespace
+{
+   /**
+    * A running total of prices, quantities and splits, the
+    * kind of chain rat mode is for.
+    */
+   template <typename number_t>
+   void ledger(bench_state_t& state)
+   {
+      const std::string tokens[] = {"19.99", "+", "3", "*", "7", "/", "2.50", "-"};
+      basic_postfix_t<number_t> p;
+      while (state.keep_running())
+      {
+         p.clear();
+         p.push(0);
+         for (long i = 0; i < state.arg(); ++i)
+         {
+            for (const std::string& token : tokens)
+            {
+               p.push(token);
+            }
+         }
+      }
+      do_not_optimize(p);
+   }
+}
+
+BENCH_ARGS(ledger_dec, 10, 100)
+{
+   ledger<num_t>(state);
+}
+
+BENCH_ARGS(ledger_rat, 10, 100)
+{
+   ledger<rat_t>(state);
+}
@@ -0,0 +1,204 @@
+#ifndef __budget_t_hpp__
+#define __budget_t_hpp__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Limits how much work one push or one evaluation may do.
+ * Loops in the operators charge the budget once per step and
+ * the budget throws "cancelled" when the step limit or the
+ * deadline is exceeded or when cancel() has been called.
+ * cancel() only sets an atomic flag, so a signal handler or a
+ * watchdog thread may call it while a push is running.
+ */
+struct budget_t
+{
+   using clock_type = std::chrono::steady_clock;
+
+   budget_t()
+      :cancelled_(false)
+      ,step_limit_(0)
+      ,time_limit_(0)
+      ,steps_(0)
+      ,depth_(0)
+   {
+   }
+
+   // The limits are copied; the state of a running push is
+   // not.
+   budget_t(const budget_t& rhs)
+      :cancelled_(false)
+      ,step_limit_(rhs.step_limit_)
+      ,time_limit_(rhs.time_limit_)
+      ,steps_(0)
+      ,depth_(0)
+   {
+   }
+
+   budget_t& operator=(const budget_t& rhs)
+   {
+      step_limit_ = rhs.step_limit_;
+      time_limit_ = rhs.time_limit_;
+      return *this;
+   }
+
+   /**
+    * @param[in] steps the number of loop steps allowed per
+    * unit of work, 0 for no limit
+    */
+   void step_limit(std::uint64_t steps)
+   {
+      step_limit_ = steps;
+   }
+
+   std::uint64_t step_limit() const
+   {
+      return step_limit_;
+   }
+
+   /**
+    * @param[in] limit how long a unit of work may run, 0 for
+    * no limit
+    */
+   void time_limit(clock_type::duration limit)
+   {
+      time_limit_ = limit;
+   }
+
+   clock_type::duration time_limit() const
+   {
+      return time_limit_;
+   }
+
+   /**
+    * Stop the running work at its next step. Safe to call
+    * from a signal handler or another thread.
+    */
+   void cancel()
+   {
+      cancelled_.store(true, std::memory_order_relaxed);
+   }
+
+   /**
+    * @return true when the last unit of work was cancelled or
+    * ran out of budget.
+    */
+   bool cancelled() const
+   {
+      return cancelled_.load(std::memory_order_relaxed);
+   }
+
+   /**
+    * @return true while a unit of work is running. Safe to
+    * call from a signal handler.
+    */
+   bool busy() const
+   {
+      return depth_.load(std::memory_order_relaxed) != 0;
+   }
+
+   /**
+    * Account for steps iterations of a loop.
+    * @throw "cancelled" when the work must stop
+    */
+   void charge(std::uint64_t steps = 1)
+   {
+      std::uint64_t before = steps_;
+      steps_ += steps;
+      if (step_limit_ != 0 && steps_ > step_limit_)
+      {
+         cancel();
+      }
+      // Reading the clock costs more than a step of the
+      // cheaper number types, so only look every so often.
+      else if
+      (
+         time_limit_ != clock_type::duration::zero()
+         && (before / clock_stride != steps_ / clock_stride || before == 0)
+         && clock_type::now() > deadline_
+      )
+      {
+         cancel();
+      }
+
+      if (cancelled())
+      {
+         throw "cancelled";
+      }
+   }
+
+   /**
+    * Look at the deadline and for a cancel without counting
+    * a step. It writes nothing but the cancel flag, so unlike
+    * charge() any number of threads may call it at once.
+    * @throw "cancelled" when the work must stop
+    */
+   void check()
+   {
+      if
+      (
+         time_limit_ != clock_type::duration::zero()
+         && clock_type::now() > deadline_
+      )
+      {
+         cancel();
+      }
+
+      if (cancelled())
+      {
+         throw "cancelled";
+      }
+   }
+
+   /**
+    * Marks a unit of work for as long as it is in scope. Only
+    * the outermost scope starts the budget, so operators that
+    * push other operators share their caller's budget.
+    */
+   struct scope_t
+   {
+      explicit scope_t(budget_t& budget)
+         :budget_(budget)
+      {
+         // Start before looking busy so that a cancel from
+         // another thread can't be lost to the reset.
+         if (budget_.depth_.load(std::memory_order_relaxed) == 0)
+         {
+            budget_.start();
+         }
+         ++budget_.depth_;
+      }
+
+      ~scope_t()
+      {
+         --budget_.depth_;
+      }
+
+      scope_t(const scope_t&) = delete;
+      scope_t& operator=(const scope_t&) = delete;
+
+   private:
+      budget_t& budget_;
+   };
+
+private:
+   static constexpr std::uint64_t clock_stride = 64;
+
+   void start()
+   {
+      cancelled_.store(false, std::memory_order_relaxed);
+      steps_ = 0;
+      deadline_ = clock_type::now() + time_limit_;
+   }
+
+   std::atomic<bool> cancelled_;
+   std::uint64_t step_limit_;
+   clock_type::duration time_limit_;
+   std::uint64_t steps_;
+   clock_type::time_point deadline_;
+   std::atomic<unsigned> depth_;
+};
+
+#endif
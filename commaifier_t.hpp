@@ -1,29 +1,143 @@
 #pragma once
 
-#include "debug.hpp"
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
 
+/**
+ * Groups the integer digits of a number's text, writing
+ * straight into the output as it goes. The sign, the
+ * fraction and any exponent are copied through as they are,
+ * as is text with no integer digits, such as inf or .5.
+ */
 struct commaifier_t
 {
-    commaifier_t(const std::string& s)
+    /**
+     * @param[in] group the number of digits per group, 0 for
+     * no grouping
+     * @param[in] separator what goes between groups
+     */
+    explicit commaifier_t(std::size_t group = 3, char separator = ',')
+        :group_(group)
+        ,separator_(separator)
     {
-        const int len = s.size();
-        s_.reserve(len + (len - 1) / 3);
-        int rotor = 3 - len % 3;
-        for (auto c : s)
+    }
+
+    std::size_t group() const
+    {
+        return group_;
+    }
+
+    char separator() const
+    {
+        return separator_;
+    }
+
+    /**
+     * Append number, grouped, to out.
+     */
+    void append(std::string& out, std::string_view number) const
+    {
+        const auto [begin, end] = integer_digits(number);
+        out.reserve(out.size() + number.size() + separators(end - begin));
+        out.append(number, 0, begin);
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            if (i != begin && (end - i) % group_ == 0)
+            {
+                out.push_back(separator_);
+            }
+            out.push_back(number[i]);
+        }
+        out.append(number, end);
+    }
+
+    /**
+     * Write number, grouped, to o a group at a time.
+     */
+    void write(std::ostream& o, std::string_view number) const
+    {
+        const auto [begin, end] = integer_digits(number);
+        o.write(number.data(), begin);
+        std::size_t i = begin;
+        if (end > begin)
         {
-            if (rotor == 0)
+            std::size_t first = (end - begin) % group_;
+            if (first == 0)
             {
-                s_.push_back(',');
+                first = group_;
             }
-            rotor = (rotor + 1) % 3;
-            s_.push_back(c);
+            o.write(number.data() + i, first);
+            i += first;
+        }
+        for (; i < end; i += group_)
+        {
+            o.put(separator_);
+            o.write(number.data() + i, group_);
         }
+        o.write(number.data() + end, number.size() - end);
     }
 
-    const std::string& str() const
+    /**
+     * @return number, grouped.
+     */
+    std::string str(std::string_view number) const
     {
-        return s_;
+        std::string result;
+        append(result, number);
+        return result;
     }
+
+    bool operator==(const commaifier_t& rhs) const
+    {
+        return group_ == rhs.group_ && separator_ == rhs.separator_;
+    }
+
+    bool operator!=(const commaifier_t& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
 private:
-    std::string s_;
+    struct range_t
+    {
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    /**
+     * @return where the digits before any point or exponent
+     * are, an empty range when grouping is off.
+     */
+    range_t integer_digits(std::string_view number) const
+    {
+        std::size_t begin = 0;
+        while
+        (
+            begin < number.size()
+            && (number[begin] == '-' || number[begin] == '+' || number[begin] == ' ')
+        )
+        {
+            ++begin;
+        }
+        std::size_t end = begin;
+        while (end < number.size() && number[end] >= '0' && number[end] <= '9')
+        {
+            ++end;
+        }
+        if (group_ == 0)
+        {
+            end = begin;
+        }
+        return {begin, end};
+    }
+
+    std::size_t separators(std::size_t digits) const
+    {
+        return digits == 0 ? 0 : (digits - 1) / group_;
+    }
+
+    std::size_t group_;
+    char separator_;
 };
@@ -0,0 +1,77 @@
+#ifndef __compiler_t_hpp__
+#define __compiler_t_hpp__
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include <boost/algorithm/string.hpp>
+#include "debug.hpp"
+#include "program_t.hpp"
+#include "infix_t.hpp"
+
+/**
+ * Turns expressions into reusable programs.
+ */
+template <typename number_t>
+struct basic_compiler_t
+{
+   using program_type = basic_program_t<number_t>;
+
+   /**
+    * @param[in] s whitespace separated postfix tokens
+    * @param[in] inputs the names of the program's inputs
+    * @return the compiled program
+    */
+   program_type postfix
+   (
+      const std::string& s,
+      const std::vector<std::string>& inputs = std::vector<std::string>()
+   ) const
+   {
+      std::vector<std::string> tokens;
+      std::string trimmed = boost::trim_copy(s);
+      boost::split
+      (
+         tokens,
+         trimmed,
+         boost::is_space(),
+         boost::token_compress_on
+      );
+
+      program_type result(inputs);
+      for (const std::string& token : tokens)
+      {
+         if (!token.empty())
+         {
+            result.push(token);
+         }
+      }
+      return result;
+   }
+
+   /**
+    * @param[in] s an infix expression
+    * @param[in] inputs the names of the program's inputs
+    * @return the compiled program
+    */
+   program_type infix
+   (
+      const std::string& s,
+      const std::vector<std::string>& inputs = std::vector<std::string>()
+   ) const
+   {
+      program_type result(inputs);
+      infix_t<program_type> parser(result);
+      auto t = parser.parse(s);
+      const char* msg = std::get<1>(t);
+      if (std::get<0>(t) != s.cend() || *msg)
+      {
+         throw *msg ? msg : "incomplete infix expression";
+      }
+      return result;
+   }
+};
+
+using compiler_t = basic_compiler_t<num_t>;
+
+#endif
@@ -1,9 +1,49 @@
 #pragma once
 
+#include <boost/math/constants/constants.hpp>
 #include "num_t.hpp"
+#include "num_traits_t.hpp"
 
-const num_t feet_in_one_meter = 3.280839895;
-const num_t joules_in_one_foot_pound = 1.3558179483314004;
-const num_t liters_in_one_gallon = 3.785411784;
-const num_t pounds_in_one_kilogram = 0.45359237;
-const num_t watts_in_one_horsepower = 745.699872;
+// The unit factors follow from their definitions: 1 ft is
+// 0.3048 m, 1 lb is 0.45359237 kg, standard gravity is
+// 9.80665 m/s^2, 1 US gal is 3.785411784 L and 1 hp is
+// 550 ft lbf/s. Each is written as exact decimal text, or
+// for feet per meter as the ratio 1250/381, so every number
+// type gets the factor to its own precision rather than a
+// double's approximation of it.
+template <typename number_t>
+const number_t feet_in_one_meter = number_t(1250) / 381;
+template <typename number_t>
+const number_t joules_in_one_foot_pound =
+   num_traits_t<number_t>::parse("1.3558179483314004");
+template <typename number_t>
+const number_t liters_in_one_gallon =
+   num_traits_t<number_t>::parse("3.785411784");
+template <typename number_t>
+const number_t pounds_in_one_kilogram =
+   num_traits_t<number_t>::parse("0.45359237");
+template <typename number_t>
+const number_t watts_in_one_horsepower =
+   num_traits_t<number_t>::parse("745.69987158227022");
+
+/**
+ * Mathematical constants at number_t's precision. Each is
+ * computed the first time it is asked for and copied from
+ * then on; the first call is safe to race from several
+ * threads.
+ */
+template <typename number_t>
+struct constants_t
+{
+   static const number_t& pi()
+   {
+      static const number_t value = boost::math::constants::pi<number_t>();
+      return value;
+   }
+
+   static const number_t& e()
+   {
+      static const number_t value = boost::math::constants::e<number_t>();
+      return value;
+   }
+};
@@ -0,0 +1,214 @@
+#ifndef __factorial_t_hpp__
+#define __factorial_t_hpp__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <boost/math/special_functions/fpclassify.hpp>
+#include <boost/math/special_functions/gamma.hpp>
+#include "budget_t.hpp"
+
+/**
+ * Computes x! for any number type the engine runs on.
+ *
+ * - 0! through 20! come from a table.
+ * - Larger integers, up to tree_limit, are a product tree:
+ *   runs of consecutive factors are multiplied together in
+ *   64 bits and the runs are then multiplied pairwise, so
+ *   every multiplication is between operands of similar size.
+ *   While the result fits in number_t's precision it is
+ *   exact.
+ * - Everything else, fractions and huge integers, is
+ *   tgamma(x + 1). Negative integers are poles and give nan;
+ *   results beyond number_t's range give inf. An exact type
+ *   has neither, so both throw instead, and an integer type
+ *   has no tgamma, so beyond tree_limit it throws too.
+ *
+ * Results that were not in the table are remembered in a
+ * small cache, replaced oldest first. The product tree
+ * charges a budget, when it is given one, per
+ * multiplication; tgamma runs to completion.
+ */
+template <typename number_t>
+struct factorial_t
+{
+   static constexpr std::uint64_t tree_limit = 10000;
+
+   /**
+    * @param[in] capacity the number of results to remember
+    */
+   explicit factorial_t(std::size_t capacity = 16)
+      :capacity_(capacity)
+      ,next_(0)
+   {
+      cache_.reserve(capacity_);
+   }
+
+   /**
+    * @return x!, from the cache when it has been asked for
+    * recently.
+    */
+   number_t operator()(const number_t& x, budget_t* budget = nullptr)
+   {
+      if (x >= 0 && x < table_.size() && whole(x))
+      {
+         return compute(x);
+      }
+
+      for (const auto& entry : cache_)
+      {
+         if (entry.first == x)
+         {
+            return entry.second;
+         }
+      }
+
+      number_t result = compute(x, budget);
+      if (capacity_ == 0)
+      {
+         return result;
+      }
+      if (cache_.size() < capacity_)
+      {
+         cache_.emplace_back(x, result);
+      }
+      else
+      {
+         cache_[next_] = std::make_pair(x, result);
+         next_ = (next_ + 1) % capacity_;
+      }
+      return result;
+   }
+
+   /**
+    * @return x! without consulting the cache.
+    */
+   static number_t compute(const number_t& x, budget_t* budget = nullptr)
+   {
+      using limits = std::numeric_limits<number_t>;
+      if constexpr (limits::has_quiet_NaN)
+      {
+         if (boost::math::isnan(x) || x == limits::infinity())
+         {
+            return x;
+         }
+      }
+      if (whole(x))
+      {
+         if (x < 0)
+         {
+            if constexpr (limits::has_quiet_NaN)
+            {
+               return limits::quiet_NaN();
+            }
+            else
+            {
+               throw "factorial of a negative integer";
+            }
+         }
+         if (x < table_.size())
+         {
+            return number_t(table_[static_cast<std::size_t>(x)]);
+         }
+         if (x <= tree_limit)
+         {
+            return product(static_cast<std::uint64_t>(x), budget);
+         }
+      }
+
+      if constexpr (limits::is_integer)
+      {
+         throw "factorial too large";
+      }
+      else if constexpr (limits::is_exact)
+      {
+         // An exact type brings its own tgamma.
+         return tgamma(number_t(x + 1));
+      }
+      else
+      {
+         try
+         {
+            return boost::math::tgamma(number_t(x + 1));
+         }
+         catch (const std::overflow_error&)
+         {
+            return limits::infinity();
+         }
+      }
+   }
+
+private:
+   static bool whole(const number_t& x)
+   {
+      if constexpr (std::numeric_limits<number_t>::is_integer)
+      {
+         return true;
+      }
+      else
+      {
+         return x == floor(x);
+      }
+   }
+
+   /**
+    * @return 2 * 3 * ... * n as a product tree.
+    */
+   static number_t product(std::uint64_t n, budget_t* budget)
+   {
+      std::vector<number_t> level;
+      std::uint64_t run = 1;
+      for (std::uint64_t i = 2; i <= n; ++i)
+      {
+         if (run > std::numeric_limits<std::uint64_t>::max() / i)
+         {
+            level.emplace_back(run);
+            run = 1;
+         }
+         run *= i;
+      }
+      level.emplace_back(run);
+
+      while (level.size() > 1)
+      {
+         std::size_t half = 0;
+         for (std::size_t i = 0; i + 1 < level.size(); i += 2)
+         {
+            if (budget)
+            {
+               budget->charge();
+            }
+            level[half++] = level[i] * level[i + 1];
+         }
+         if (level.size() % 2 == 1)
+         {
+            level[half++] = std::move(level.back());
+         }
+         level.resize(half);
+      }
+      return level.front();
+   }
+
+   static constexpr std::array<std::uint64_t, 21> make_table()
+   {
+      std::array<std::uint64_t, 21> result{};
+      result[0] = 1;
+      for (std::size_t i = 1; i < result.size(); ++i)
+      {
+         result[i] = result[i - 1] * i;
+      }
+      return result;
+   }
+
+   static constexpr std::array<std::uint64_t, 21> table_ = make_table();
+
+   std::size_t capacity_;
+   std::size_t next_;
+   std::vector<std::pair<number_t, number_t>> cache_;
+};
+
+#endif
@@ -10,15 +10,19 @@
 #include "postfix_t.hpp"
 
 /**
- * An infix expression parser.
+ * An infix expression parser. The target receives the
+ * expression as a sequence of postfix tokens through
+ * push(const std::string&), which makes it either an engine
+ * that evaluates as it goes or a program_t that records the
+ * tokens for later.
  */
-
+template <typename target_t>
 struct infix_t
 {
    /**
     * @param[in] p the computation engine
     */
-   infix_t(postfix_t& p)
+   infix_t(target_t& p)
    :p_(p)
    {
    }
@@ -269,7 +273,7 @@ private:
       return result;
    }
 
-   postfix_t& p_;
+   target_t& p_;
    std::string::const_iterator begin_;
    std::string::const_iterator i_;
    std::string::const_iterator end_;
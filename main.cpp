@@ -1,59 +1,361 @@
 #include <iostream>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include "postfix_t.hpp"
 #include "log_t.hpp"
 #include "infix_t.hpp"
+#include "compiler_t.hpp"
+#include "optimizer_t.hpp"
+#include "batch_t.hpp"
+#include "stack_view_t.hpp"
+#include "rat_t.hpp"
 
-int main()
+namespace
 {
-   std::string buf;
-   std::string last_expression;
-   postfix_t p;
-   infix_t infix(p);
-   p.push("eng");
-   while (true)
+   int usage(const char* argv0)
    {
-      p.shrink_to_fit();
-      std::cout
-         << "[ "
-         << p
-         << " ]> ";
+      std::cerr
+         << "usage: " << argv0
+         << " [-b backend] [-t seconds] [-s steps] [-w count] [-g group]\n"
+         << "       " << argv0
+         << " [-b backend] [-t seconds] [-s steps]"
+         << " -e expr [-i name,...] [-p] [-c]\n"
+         << '\n'
+         << "Without -e, run interactively.\n"
+         << '\n'
+         << "  -b backend number type: double, float128, dec50, dec100,\n"
+         << "             dec1024 (the default), rat for exact fractions\n"
+         << "             or int for integers of any width\n"
+         << "  -t seconds give up on a line after this long\n"
+         << "  -s steps   give up on a line after this many loop steps\n"
+         << "  -w count   show at most count stack entries, 0 for all\n"
+         << "  -g group   com mode's digits per group, 0 for none, and an\n"
+         << "             optional separator after it: 3 (the default), 4_\n"
+         << "  -e expr    evaluate expr once per line of standard input\n"
+         << "  -i names   comma separated names bound to each line's fields\n"
+         << "  -p         expr is postfix rather than infix\n"
+         << "  -c         fields are comma separated rather than whitespace\n";
+      return 2;
+   }
+
+   struct options_t
+   {
+      std::string backend = "dec1024";
+      std::string expression;
+      std::vector<std::string> inputs;
+      bool postfix = false;
+      bool csv = false;
+      double seconds = 0;
+      std::uint64_t steps = 0;
+      std::size_t window = 8;
+      commaifier_t grouping;
+   };
+
+   bool parse_options(int argc, char** argv, options_t& options)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         if (std::strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+         {
+            options.backend = argv[++i];
+         }
+         else if (std::strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+         {
+            options.expression = argv[++i];
+         }
+         else if (std::strcmp(argv[i], "-i") == 0 && i + 1 < argc)
+         {
+            boost::split(options.inputs, argv[++i], boost::is_any_of(","));
+         }
+         else if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+         {
+            options.seconds = std::atof(argv[++i]);
+         }
+         else if (std::strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+         {
+            options.steps = std::strtoull(argv[++i], nullptr, 10);
+         }
+         else if (std::strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+         {
+            options.window = std::strtoul(argv[++i], nullptr, 10);
+         }
+         else if (std::strcmp(argv[i], "-g") == 0 && i + 1 < argc)
+         {
+            char* separator = nullptr;
+            const std::size_t group = std::strtoul(argv[++i], &separator, 10);
+            options.grouping = commaifier_t
+            (
+               group,
+               *separator ? *separator : options.grouping.separator()
+            );
+         }
+         else if (std::strcmp(argv[i], "-p") == 0)
+         {
+            options.postfix = true;
+         }
+         else if (std::strcmp(argv[i], "-c") == 0)
+         {
+            options.csv = true;
+         }
+         else
+         {
+            return false;
+         }
+      }
+      return true;
+   }
 
-      std::getline(std::cin, buf);
-      if (std::cin.eof())
+   void limit(const options_t& options, budget_t& budget)
+   {
+      budget.step_limit(options.steps);
+      budget.time_limit
+      (
+         std::chrono::duration_cast<budget_t::clock_type::duration>
+         (
+            std::chrono::duration<double>(options.seconds)
+         )
+      );
+   }
+
+   budget_t* interruptible = nullptr;
+
+   /**
+    * Ctrl-C cancels the line being worked on. At the prompt
+    * it quits as usual.
+    */
+   void interrupt(int signal)
+   {
+      if (interruptible && interruptible->busy())
       {
-         return 0;
+         interruptible->cancel();
+         return;
       }
+      std::signal(signal, SIG_DFL);
+      std::raise(signal);
+   }
 
-      if (buf.size() == 0)
+   template <typename number_t>
+   int batch(const options_t& options)
+   {
+      try
+      {
+         basic_compiler_t<number_t> compiler;
+         // The program runs once per record, so it pays to
+         // optimize it first.
+         basic_program_t<number_t> program = basic_optimizer_t<number_t>()
+         (
+            options.postfix
+               ? compiler.postfix(options.expression, options.inputs)
+               : compiler.infix(options.expression, options.inputs)
+         );
+         basic_batch_t<number_t> b(program, options.csv);
+         limit(options, b.budget());
+         return b.run(std::cin, std::cout, std::cerr) == 0 ? 0 : 1;
+      }
+      catch (const char* e)
       {
-         buf = last_expression;
+         std::cerr << "'" << options.expression << "': " << e << '\n';
+         return 2;
       }
-      last_expression = buf;
+   }
 
-      bool push_failed = false;
+   /**
+    * Handle the lines that manage definitions:
+    *
+    *    def name tokens... end
+    *    undef name
+    *    defs
+    *
+    * and calls to them. A call that fails has already pushed
+    * some of its values, so it isn't tried again as infix.
+    * @return true when line was one of them
+    */
+   template <typename number_t>
+   bool definition(basic_postfix_t<number_t>& p, const std::string& line)
+   {
+      std::vector<std::string> words;
+      std::string trimmed = boost::trim_copy(line);
+      boost::split(words, trimmed, boost::is_space(), boost::token_compress_on);
+      const std::string command = boost::algorithm::to_lower_copy(words[0]);
       try
       {
-         p.push(buf);
+         if (command == "def")
+         {
+            if (words.size() < 3 || !boost::iequals(words.back(), "end"))
+            {
+               throw "def name tokens... end";
+            }
+            p.define
+            (
+               words[1],
+               boost::join(boost::make_iterator_range(words.begin() + 2, words.end() - 1), " ")
+            );
+         }
+         else if (command == "undef" && words.size() == 2)
+         {
+            if (!p.undefine(words[1]))
+            {
+               throw "not defined";
+            }
+         }
+         else if (command == "defs" && words.size() == 1)
+         {
+            for (const auto& d : p.definitions())
+            {
+               std::cout << "def " << d.first << ' ' << d.second << " end\n";
+            }
+         }
+         else if (words.size() == 1 && p.defined(command))
+         {
+            p.push(command);
+         }
+         else
+         {
+            return false;
+         }
       }
       catch (const char* e)
       {
-         push_failed = true;
+         ooo(eee) << e;
       }
+      return true;
+   }
 
-      if (push_failed)
+   template <typename number_t>
+   int repl(const options_t& options)
+   {
+      std::string buf;
+      std::string last_expression;
+      basic_postfix_t<number_t> p;
+      basic_stack_view_t<number_t> view(options.window);
+      infix_t infix(p);
+      p.push("eng");
+      p.grouping(options.grouping);
+      limit(options, p.budget());
+      interruptible = &p.budget();
+      std::signal(SIGINT, interrupt);
+      while (true)
       {
-         auto t = infix.parse(buf);
-         auto i = std::get<0>(t);
-         auto msg = std::get<1>(t);
-         auto end = buf.cend();
-         if (i != end)
+         std::cout << "[ ";
+         view.render(std::cout, p);
+         std::cout << " ]> ";
+
+         std::getline(std::cin, buf);
+         if (std::cin.eof())
+         {
+            return 0;
+         }
+
+         if (buf.size() == 0)
+         {
+            buf = last_expression;
+         }
+         last_expression = buf;
+
+         // One budget covers the whole line, however many
+         // pushes the infix parser turns it into, and a line
+         // that is cancelled part way leaves the stack as it
+         // found it.
+         budget_t::scope_t scope(p.budget());
+         const auto checkpoint = p.checkpoint();
+         if (!definition(p, buf))
          {
-            int diff = end - i;
-            ooo(eee)
-               << msg
-               << ": diff = "
-               << diff;
+            bool push_failed = false;
+            try
+            {
+               p.push(buf);
+            }
+            catch (const char* e)
+            {
+               push_failed = true;
+               if (p.budget().cancelled())
+               {
+                  ooo(eee) << e;
+               }
+            }
+
+            if (push_failed && !p.budget().cancelled())
+            {
+               auto t = infix.parse(buf);
+               auto i = std::get<0>(t);
+               auto msg = std::get<1>(t);
+               auto end = buf.cend();
+               if (p.budget().cancelled())
+               {
+                  ooo(eee) << "cancelled";
+               }
+               else if (*msg && i == end)
+               {
+                  // The line parsed but an operator refused
+                  // it, like rat's 125 past.
+                  ooo(eee) << msg;
+               }
+               else if (i != end)
+               {
+                  int diff = end - i;
+                  ooo(eee)
+                     << msg
+                     << ": diff = "
+                     << diff;
+               }
+            }
          }
+         if (p.budget().cancelled() && !p.restore(checkpoint))
+         {
+            ooo(eee) << "the stack could not be put back";
+         }
+      }
+   }
+
+   template <typename number_t>
+   int run(const options_t& options)
+   {
+      if (options.expression.empty())
+      {
+         return repl<number_t>(options);
       }
+      return batch<number_t>(options);
+   }
+}
+
+int main(int argc, char** argv)
+{
+   options_t options;
+   if (!parse_options(argc, argv, options))
+   {
+      return usage(argv[0]);
+   }
+
+   if (options.backend == "dec1024")
+   {
+      return run<num_t>(options);
+   }
+   else if (options.backend == "dec100")
+   {
+      return run<dec100_t>(options);
+   }
+   else if (options.backend == "dec50")
+   {
+      return run<dec50_t>(options);
+   }
+   else if (options.backend == "float128")
+   {
+      return run<float128_t>(options);
+   }
+   else if (options.backend == "double")
+   {
+      return run<double>(options);
+   }
+   else if (options.backend == "rat")
+   {
+      return run<rat_t>(options);
+   }
+   else if (options.backend == "int")
+   {
+      return run<int_t>(options);
    }
+   return usage(argv[0]);
 }
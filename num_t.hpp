@@ -1,7 +1,9 @@
 #ifndef __num_t_hpp__
 #define __num_t_hpp__
 
+#include <cstdint>
 #include <boost/multiprecision/cpp_dec_float.hpp>
+#include <boost/multiprecision/cpp_bin_float.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
 
 using int_t = boost::multiprecision::number
@@ -16,4 +18,35 @@ using num_t = boost::multiprecision::number
    boost::multiprecision::expression_template_option::et_off
 >;
 
+// Cheaper alternatives to num_t for when throughput matters
+// more than precision. double is also supported directly.
+
+using dec50_t = boost::multiprecision::number
+<
+   boost::multiprecision::cpp_dec_float<50>,
+   boost::multiprecision::expression_template_option::et_off
+>;
+
+using dec100_t = boost::multiprecision::number
+<
+   boost::multiprecision::cpp_dec_float<100>,
+   boost::multiprecision::expression_template_option::et_off
+>;
+
+// IEEE 754 binary128 layout, implemented in software so it
+// needs neither libquadmath nor compiler extensions.
+using float128_t = boost::multiprecision::number
+<
+   boost::multiprecision::cpp_bin_float
+   <
+      113,
+      boost::multiprecision::backends::digit_base_2,
+      void,
+      std::int16_t,
+      -16382,
+      16383
+   >,
+   boost::multiprecision::expression_template_option::et_off
+>;
+
 #endif
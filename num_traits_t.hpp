@@ -0,0 +1,181 @@
+#ifndef __num_traits_t_hpp__
+#define __num_traits_t_hpp__
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <ios>
+#include <iosfwd>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include "num_t.hpp"
+
+/**
+ * Conversions between text and the number types the engine
+ * can be instantiated with. The primary template covers the
+ * boost::multiprecision types.
+ */
+template <typename number_t>
+struct num_traits_t
+{
+   /**
+    * @throw std::runtime_error when s is not a number
+    */
+   static number_t parse(const std::string& s)
+   {
+      number_t result(s);
+      return result;
+   }
+
+   /**
+    * @param[in] digits how many significant digits to
+    * generate, rounded to nearest; 0 for all of them
+    */
+   static std::string str(const number_t& n, std::streamsize digits = 0)
+   {
+      std::string result = n.str(digits);
+      return result;
+   }
+
+   // Boost converts between cpp_int and cpp_dec_float a piece
+   // at a time, which takes milliseconds at a thousand digits.
+   // Their decimal text converts in microseconds, so the
+   // decimal types go through it.
+
+   /**
+    * @return a non-negative integral n as an int_t.
+    */
+   static int_t to_int(const number_t& n)
+   {
+      if (n <= std::numeric_limits<unsigned long long>::max())
+      {
+         return int_t(static_cast<unsigned long long>(n));
+      }
+      if constexpr (std::numeric_limits<number_t>::radix == 10)
+      {
+         std::string digits = n.str(0, std::ios_base::fixed);
+         digits.erase(std::min(digits.find('.'), digits.size()));
+         return int_t(digits);
+      }
+      else
+      {
+         return static_cast<int_t>(n);
+      }
+   }
+
+   /**
+    * @return the number_t nearest to i.
+    */
+   static number_t from_int(const int_t& i)
+   {
+      if constexpr (std::numeric_limits<number_t>::radix == 10)
+      {
+         if (i <= std::numeric_limits<unsigned long long>::max() && i >= 0)
+         {
+            return number_t(static_cast<unsigned long long>(i));
+         }
+         return number_t(i.str());
+      }
+      else
+      {
+         return static_cast<number_t>(i);
+      }
+   }
+};
+
+/**
+ * The integer engine's numbers are int_t themselves.
+ */
+template <>
+struct num_traits_t<int_t>
+{
+   /**
+    * @throw std::runtime_error unless s is an optional minus
+    * sign and decimal digits
+    */
+   static int_t parse(const std::string& s)
+   {
+      const std::size_t sign = !s.empty() && s.front() == '-';
+      if
+      (
+         s.size() == sign
+         || s.find_first_not_of("0123456789", sign) != std::string::npos
+      )
+      {
+         throw std::runtime_error("invalid integer");
+      }
+      // int_t reads a leading 0 as an octal prefix.
+      const std::size_t first = std::min(s.find_first_not_of('0', sign), s.size() - 1);
+      int_t result(s.substr(first));
+      return sign ? int_t(-result) : result;
+   }
+
+   /**
+    * Integers are always shown with every digit, so digits is
+    * ignored.
+    */
+   static std::string str(const int_t& n, std::streamsize = 0)
+   {
+      return n.str();
+   }
+
+   static const int_t& to_int(const int_t& n)
+   {
+      return n;
+   }
+
+   static const int_t& from_int(const int_t& i)
+   {
+      return i;
+   }
+};
+
+template <>
+struct num_traits_t<double>
+{
+   static double parse(const std::string& s)
+   {
+      const char* begin = s.c_str();
+      char* end = nullptr;
+      double result = std::strtod(begin, &end);
+      if (s.empty() || end != begin + s.size())
+      {
+         throw std::runtime_error("invalid double");
+      }
+      return result;
+   }
+
+   /**
+    * @return the shortest text that reads back as n, or n
+    * rounded to digits significant digits.
+    */
+   static std::string str(double n, std::streamsize digits = 0)
+   {
+      char buf[32];
+      auto r = digits == 0
+         ? std::to_chars(buf, buf + sizeof(buf), n)
+         : std::to_chars
+         (
+            buf,
+            buf + sizeof(buf),
+            n,
+            std::chars_format::general,
+            static_cast<int>(std::min<std::streamsize>(digits, 17))
+         );
+      std::string result(buf, r.ptr);
+      return result;
+   }
+
+   static int_t to_int(double n)
+   {
+      return static_cast<int_t>(n);
+   }
+
+   static double from_int(const int_t& i)
+   {
+      return static_cast<double>(i);
+   }
+};
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef __op_t_hpp__
+#define __op_t_hpp__
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Every operator the engine understands as X(identifier,
+ * name). Expanding this list generates the op_t enumeration,
+ * the name table, the perfect hash over the names and the
+ * engine's dispatch switch, so adding an operator is one
+ * line here plus its handler in basic_postfix_t.
+ */
+#define MANCALC_OPERATORS(X) \
+   X(add, "+") \
+   X(subtract, "-") \
+   X(multiply, "*") \
+   X(divide, "/") \
+   X(modulo, "%") \
+   X(shift_left, "<<") \
+   X(shift_right, ">>") \
+   X(bit_and, "&") \
+   X(bit_or, "|") \
+   X(bit_xor, "^^") \
+   X(bit_not, "~") \
+   X(power, "^") \
+   X(factorial, "!") \
+   X(increment, "++") \
+   X(decrement, "--") \
+   X(abs, "abs") \
+   X(acos, "acos") \
+   X(asin, "asin") \
+   X(atan, "atan") \
+   X(atan2, "atan2") \
+   X(mil, "mil") \
+   X(mph, "mph") \
+   X(gam, "gam") \
+   X(lor, "lor") \
+   X(avg, "avg") \
+   X(bin, "bin") \
+   X(c, "c") \
+   X(ceil, "ceil") \
+   X(cf, "cf") \
+   X(past, "past") \
+   X(clear, "clear") \
+   X(clr, "clr") \
+   X(clz, "clz") \
+   X(cos, "cos") \
+   X(cosh, "cosh") \
+   X(dec, "dec") \
+   X(com, "com") \
+   X(digits, "digits") \
+   X(group, "group") \
+   X(e, "e") \
+   X(exp, "exp") \
+   X(eng, "eng") \
+   X(fc, "fc") \
+   X(floor, "floor") \
+   X(fj, "fj") \
+   X(frac, "frac") \
+   X(frexp, "frexp") \
+   X(fm, "fm") \
+   X(gl, "gl") \
+   X(hex, "hex") \
+   X(hw, "hw") \
+   X(jf, "jf") \
+   X(kp, "kp") \
+   X(lg, "lg") \
+   X(log, "log") \
+   X(l2, "l2") \
+   X(log2, "log2") \
+   X(ln, "ln") \
+   X(mf, "mf") \
+   X(neg, "neg") \
+   X(oct, "oct") \
+   X(pk, "pk") \
+   X(pi, "pi") \
+   X(pop, "pop") \
+   X(p, "p") \
+   X(popcount, "popcount") \
+   X(prod, "prod") \
+   X(round, "round") \
+   X(seq0, "seq0") \
+   X(seq1, "seq1") \
+   X(seq2, "seq2") \
+   X(seq3, "seq3") \
+   X(sin, "sin") \
+   X(sinh, "sinh") \
+   X(sqrt, "sqrt") \
+   X(stddev, "stddev") \
+   X(stats, "stats") \
+   X(sum, "sum") \
+   X(swap, "swap") \
+   X(sw, "sw") \
+   X(tan, "tan") \
+   X(tanh, "tanh") \
+   X(trunc, "trunc") \
+   X(wh, "wh") \
+   X(pr, "pr")
+
+enum class op_t : std::uint8_t
+{
+#define X(id, name) id,
+   MANCALC_OPERATORS(X)
+#undef X
+};
+
+/**
+ * The name of each operator, indexed by op_t.
+ */
+inline constexpr std::string_view op_names[] =
+{
+#define X(id, name) name,
+   MANCALC_OPERATORS(X)
+#undef X
+};
+
+inline constexpr std::size_t op_count =
+   sizeof(op_names) / sizeof(op_names[0]);
+
+static_assert(op_count < 0xff, "op_slots_t::index is too narrow");
+
+constexpr char op_fold_case(char c)
+{
+   return ('A' <= c && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+/**
+ * Case insensitive FNV-1a, perturbed by seed.
+ */
+constexpr std::uint32_t op_hash(std::string_view s, std::uint32_t seed)
+{
+   std::uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+   for (char c : s)
+   {
+      h ^= static_cast<unsigned char>(op_fold_case(c));
+      h *= 16777619u;
+   }
+   return h ^ (h >> 15);
+}
+
+constexpr std::size_t op_slot_count()
+{
+   // A sparse table keeps the expected number of seeds
+   // tried at compile time small.
+   std::size_t result = 1;
+   while (result < op_count * 16)
+   {
+      result <<= 1;
+   }
+   return result;
+}
+
+/**
+ * A collision free mapping from op_hash() to op_t.
+ */
+struct op_slots_t
+{
+   static constexpr std::size_t size = op_slot_count();
+   static constexpr std::uint8_t empty = 0xff;
+
+   std::uint32_t seed;
+   std::uint8_t index[size];
+};
+
+/**
+ * Search for a seed under which no two operator names share
+ * a slot.
+ */
+constexpr op_slots_t make_op_slots()
+{
+   for (std::uint32_t seed = 1; seed < 100000; ++seed)
+   {
+      op_slots_t result{seed, {}};
+      for (std::size_t i = 0; i < op_slots_t::size; ++i)
+      {
+         result.index[i] = op_slots_t::empty;
+      }
+
+      bool perfect = true;
+      for (std::size_t i = 0; perfect && i < op_count; ++i)
+      {
+         std::size_t slot = op_hash(op_names[i], seed) & (op_slots_t::size - 1);
+         perfect = result.index[slot] == op_slots_t::empty;
+         result.index[slot] = static_cast<std::uint8_t>(i);
+      }
+
+      if (perfect)
+      {
+         return result;
+      }
+   }
+   return op_slots_t{0, {}};
+}
+
+inline constexpr op_slots_t op_slots = make_op_slots();
+
+static_assert(op_slots.seed != 0, "no perfect hash for the operator names");
+
+/**
+ * @param[in] name an operator name in any case
+ * @param[out] op the operator when name is one
+ * @return true when name is an operator
+ */
+constexpr bool find_op(std::string_view name, op_t& op)
+{
+   std::size_t slot = op_hash(name, op_slots.seed) & (op_slots_t::size - 1);
+   std::uint8_t i = op_slots.index[slot];
+   if (i == op_slots_t::empty || op_names[i].size() != name.size())
+   {
+      return false;
+   }
+   for (std::size_t j = 0; j < name.size(); ++j)
+   {
+      if (op_names[i][j] != op_fold_case(name[j]))
+      {
+         return false;
+      }
+   }
+   op = static_cast<op_t>(i);
+   return true;
+}
+
+#endif
@@ -0,0 +1,404 @@
+#ifndef __optimizer_t_hpp__
+#define __optimizer_t_hpp__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "op_t.hpp"
+#include "postfix_t.hpp"
+#include "program_t.hpp"
+
+/**
+ * Rewrites a program to do the same work with fewer bignum
+ * operations.
+ *
+ * The program is read as runs of pure operators, those whose
+ * result depends only on their operands, and each run is
+ * turned into expression trees. Along the way:
+ *
+ * - an operator whose operands are all constants is run once
+ *   now and replaced by its result, so 2 8 ^ and pi 2 * cost
+ *   nothing per run;
+ * - a subexpression that appears more than once is computed
+ *   once, kept in a slot and copied from there;
+ * - x x *, once x is shared, multiplies x by a copy of
+ *   itself rather than by a second copy pushed for it. x 2 ^
+ *   is left alone: pow(x, 2) need not round as x * x does.
+ *
+ * Anything else, an operator that isn't pure or one that
+ * reaches below the values the run pushed, ends the run and
+ * is kept as it was, so the program still works on whatever
+ * stack it is given. The results are the same to the last
+ * digit because every value is still computed by the engine
+ * the same way; only fewer of them are.
+ */
+template <typename number_t>
+struct basic_optimizer_t
+{
+   using program_type = basic_program_t<number_t>;
+   using postfix_type = basic_postfix_t<number_t>;
+
+   // How many loop steps folding one operator may take;
+   // beyond it the operator is left to run time.
+   static constexpr std::uint64_t fold_steps = 100000;
+
+   basic_optimizer_t()
+   {
+      scratch_.budget().step_limit(fold_steps);
+   }
+
+   /**
+    * @return program, optimized. A program that has already
+    * been optimized comes back as it is.
+    */
+   program_type operator()(const program_type& program)
+   {
+      for (const instruction_t& i : program.code_)
+      {
+         if (i.opcode != opcode_t::constant && i.opcode != opcode_t::input && i.opcode != opcode_t::call)
+         {
+            return program;
+         }
+      }
+      result_ = program_type();
+      result_.inputs_ = program.inputs_;
+      constants_.clear();
+      nodes_.clear();
+      index_.clear();
+      stack_.clear();
+
+      for (const instruction_t& i : program.code_)
+      {
+         switch (i.opcode)
+         {
+            case opcode_t::constant:
+               stack_.push_back(constant(program.constants_[i.operand]));
+               break;
+            case opcode_t::input:
+               stack_.push_back(intern({kind_t::input, i.operand, {none, none}}));
+               break;
+            default:
+               call(static_cast<op_t>(i.operand));
+               break;
+         }
+      }
+      flush();
+      return result_;
+   }
+
+   /**
+    * @return how many values op takes, or -1 when it is not
+    * a pure operator with a single result.
+    */
+   static int arity(op_t op)
+   {
+      switch (op)
+      {
+         case op_t::c:
+         case op_t::e:
+         case op_t::pi:
+            return 0;
+         case op_t::bit_not:
+         case op_t::popcount:
+         case op_t::clz:
+         case op_t::factorial:
+         case op_t::increment:
+         case op_t::decrement:
+         case op_t::abs:
+         case op_t::acos:
+         case op_t::asin:
+         case op_t::atan:
+         case op_t::gam:
+         case op_t::lor:
+         case op_t::ceil:
+         case op_t::cf:
+         case op_t::past:
+         case op_t::cos:
+         case op_t::cosh:
+         case op_t::exp:
+         case op_t::fc:
+         case op_t::floor:
+         case op_t::fj:
+         case op_t::frac:
+         case op_t::fm:
+         case op_t::gl:
+         case op_t::hw:
+         case op_t::jf:
+         case op_t::kp:
+         case op_t::lg:
+         case op_t::log:
+         case op_t::l2:
+         case op_t::log2:
+         case op_t::ln:
+         case op_t::mf:
+         case op_t::neg:
+         case op_t::pk:
+         case op_t::round:
+         case op_t::sin:
+         case op_t::sinh:
+         case op_t::sqrt:
+         case op_t::tan:
+         case op_t::tanh:
+         case op_t::trunc:
+         case op_t::wh:
+         case op_t::pr:
+            return 1;
+         case op_t::add:
+         case op_t::subtract:
+         case op_t::multiply:
+         case op_t::divide:
+         case op_t::modulo:
+         case op_t::shift_left:
+         case op_t::shift_right:
+         case op_t::bit_and:
+         case op_t::bit_or:
+         case op_t::bit_xor:
+         case op_t::power:
+         case op_t::atan2:
+         case op_t::mil:
+         case op_t::mph:
+            return 2;
+         default:
+            return -1;
+      }
+   }
+
+private:
+   using instruction_t = typename program_type::instruction_t;
+   using opcode_t = typename program_type::opcode_t;
+
+   static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+   enum class kind_t : std::uint8_t
+   {
+      constant,
+      input,
+      call,
+      square,
+   };
+
+   /**
+    * A value in the run being read: a constant, an input or
+    * an operator applied to up to two earlier nodes.
+    */
+   struct node_t
+   {
+      kind_t kind;
+      // The constant's index in result_, the input's index
+      // or the op_t.
+      std::size_t operand;
+      std::array<std::size_t, 2> args;
+   };
+
+   using key_t = std::tuple<kind_t, std::size_t, std::size_t, std::size_t>;
+
+   /**
+    * @return the node equal to n, made if there is none yet.
+    */
+   std::size_t intern(const node_t& n)
+   {
+      const key_t key(n.kind, n.operand, n.args[0], n.args[1]);
+      auto found = index_.find(key);
+      if (found != index_.end())
+      {
+         return found->second;
+      }
+      nodes_.push_back(n);
+      index_.emplace(key, nodes_.size() - 1);
+      return nodes_.size() - 1;
+   }
+
+   /**
+    * @return the node for value. Equal constants share one,
+    * so that the expressions using them can be shared too.
+    */
+   std::size_t constant(const number_t& value)
+   {
+      // Compared as text, which tells 0 from -0.
+      const std::string text = num_traits_t<number_t>::str(value);
+      auto found = constants_.find(text);
+      if (found == constants_.end())
+      {
+         result_.constants_.push_back(value);
+         found = constants_.emplace(text, result_.constants_.size() - 1).first;
+      }
+      return intern({kind_t::constant, found->second, {none, none}});
+   }
+
+   void call(op_t op)
+   {
+      const int n = arity(op);
+      if (n < 0 || stack_.size() < static_cast<std::size_t>(n))
+      {
+         flush();
+         result_.emit(opcode_t::call, static_cast<std::size_t>(op));
+         return;
+      }
+
+      node_t node = {kind_t::call, static_cast<std::size_t>(op), {none, none}};
+      for (int i = 0; i < n; ++i)
+      {
+         node.args[i] = stack_[stack_.size() - n + i];
+      }
+      stack_.resize(stack_.size() - n);
+
+      number_t value;
+      if (fold(node, value))
+      {
+         stack_.push_back(constant(value));
+         return;
+      }
+
+      if (op == op_t::multiply && node.args[0] == node.args[1])
+      {
+         node = {kind_t::square, 0, {node.args[0], none}};
+      }
+      stack_.push_back(intern(node));
+   }
+
+   /**
+    * Run node on the scratch engine when its operands are all
+    * constants.
+    * @return true and the result in value when it could be
+    * run; an operator that fails is left to fail at run time.
+    */
+   bool fold(const node_t& node, number_t& value)
+   {
+      scratch_.clear();
+      try
+      {
+         budget_t::scope_t scope(scratch_.budget());
+         for (std::size_t arg : node.args)
+         {
+            if (arg == none)
+            {
+               break;
+            }
+            if (nodes_[arg].kind != kind_t::constant)
+            {
+               return false;
+            }
+            scratch_.push(result_.constants_[nodes_[arg].operand]);
+         }
+         scratch_.execute(static_cast<op_t>(node.operand));
+      }
+      catch (const char*)
+      {
+         return false;
+      }
+      catch (const std::exception&)
+      {
+         return false;
+      }
+      if (scratch_.depth() != 1)
+      {
+         return false;
+      }
+      value = scratch_.top();
+      return true;
+   }
+
+   /**
+    * Emit the code for the values of the run, bottom first,
+    * and start a new run.
+    */
+   void flush()
+   {
+      uses_.assign(nodes_.size(), 0);
+      for (std::size_t n : stack_)
+      {
+         count(n);
+      }
+      slot_.assign(nodes_.size(), none);
+      emitted_.assign(nodes_.size(), false);
+      for (std::size_t n : stack_)
+      {
+         emit(n);
+      }
+      nodes_.clear();
+      index_.clear();
+      stack_.clear();
+   }
+
+   void count(std::size_t n)
+   {
+      if (uses_[n]++ != 0)
+      {
+         return;
+      }
+      for (std::size_t arg : nodes_[n].args)
+      {
+         if (arg != none)
+         {
+            count(arg);
+         }
+      }
+   }
+
+   void emit(std::size_t n)
+   {
+      const node_t& node = nodes_[n];
+      switch (node.kind)
+      {
+         case kind_t::constant:
+            result_.emit(opcode_t::constant, node.operand);
+            return;
+         case kind_t::input:
+            result_.emit(opcode_t::input, node.operand);
+            return;
+         default:
+            break;
+      }
+
+      if (emitted_[n])
+      {
+         result_.emit(opcode_t::load, slot_[n]);
+         return;
+      }
+      for (std::size_t arg : node.args)
+      {
+         if (arg != none)
+         {
+            emit(arg);
+         }
+      }
+      if (node.kind == kind_t::square)
+      {
+         result_.emit(opcode_t::square, 0);
+      }
+      else
+      {
+         result_.emit(opcode_t::call, node.operand);
+      }
+      emitted_[n] = true;
+      if (uses_[n] > 1)
+      {
+         slot_[n] = result_.slots_++;
+         result_.emit(opcode_t::store, slot_[n]);
+      }
+   }
+
+   program_type result_;
+   // The constants in result_, by their text.
+   std::map<std::string, std::size_t> constants_;
+   postfix_type scratch_;
+   std::vector<node_t> nodes_;
+   std::map<key_t, std::size_t> index_;
+   // The run's values, as nodes, bottom first.
+   std::vector<std::size_t> stack_;
+   // Per node while flushing: how many times it is used, its
+   // slot and whether it has been emitted.
+   std::vector<std::size_t> uses_;
+   std::vector<std::size_t> slot_;
+   std::vector<bool> emitted_;
+};
+
+using optimizer_t = basic_optimizer_t<num_t>;
+
+#endif
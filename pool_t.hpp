@@ -0,0 +1,198 @@
+#ifndef __pool_t_hpp__
+#define __pool_t_hpp__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed set of worker threads that help callers through
+ * batches of independent jobs. The caller of run() works on
+ * its own batch too, so a batch finishes even when every
+ * worker is busy elsewhere, and run() may be called from
+ * several threads at once or from inside a job.
+ */
+struct pool_t
+{
+   /**
+    * @param[in] workers the number of threads to start
+    */
+   explicit pool_t(std::size_t workers)
+      :stop_(false)
+   {
+      for (std::size_t i = 0; i < workers; ++i)
+      {
+         threads_.emplace_back([this]() { serve(); });
+      }
+   }
+
+   pool_t(const pool_t&) = delete;
+   pool_t& operator=(const pool_t&) = delete;
+
+   ~pool_t()
+   {
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         stop_ = true;
+      }
+      ready_.notify_all();
+      for (std::thread& thread : threads_)
+      {
+         thread.join();
+      }
+   }
+
+   /**
+    * @return the pool shared by every reduction, one thread
+    * per core besides the caller's, started the first time it
+    * is asked for.
+    */
+   static pool_t& shared()
+   {
+      static pool_t pool(cores() - 1);
+      return pool;
+   }
+
+   /**
+    * @return the number of threads the hardware runs at once,
+    * at least 1.
+    */
+   static std::size_t cores()
+   {
+      return std::max(1u, std::thread::hardware_concurrency());
+   }
+
+   std::size_t workers() const
+   {
+      return threads_.size();
+   }
+
+   /**
+    * Call job(i) for every i in [0, count) and return once
+    * they have all finished. The calling thread takes jobs
+    * along with at most helpers of the workers. Once a job
+    * throws, the jobs nobody has started are skipped.
+    * @throw whatever the first job to fail threw
+    */
+   void run
+   (
+      std::size_t count,
+      std::size_t helpers,
+      const std::function<void(std::size_t)>& job
+   )
+   {
+      auto batch = std::make_shared<batch_t>(count, job);
+      helpers = std::min(helpers, threads_.size());
+      if (helpers != 0)
+      {
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.insert(queue_.end(), helpers, batch);
+         }
+         ready_.notify_all();
+      }
+      work(*batch);
+      std::unique_lock<std::mutex> lock(batch->mutex);
+      batch->finished.wait(lock, [&]() { return batch->done == count; });
+      if (batch->error)
+      {
+         std::rethrow_exception(batch->error);
+      }
+   }
+
+private:
+   struct batch_t
+   {
+      batch_t(std::size_t count, const std::function<void(std::size_t)>& job)
+         :job(job)
+         ,count(count)
+         ,next(0)
+         ,failed(false)
+         ,done(0)
+      {
+      }
+
+      // Only referenced: run() outlives every job.
+      const std::function<void(std::size_t)>& job;
+      const std::size_t count;
+      std::atomic<std::size_t> next;
+      std::atomic<bool> failed;
+      std::mutex mutex;
+      std::condition_variable finished;
+      std::size_t done;
+      std::exception_ptr error;
+   };
+
+   /**
+    * Take jobs from batch until there are none left.
+    */
+   static void work(batch_t& batch)
+   {
+      for (std::size_t i = batch.next++; i < batch.count; i = batch.next++)
+      {
+         if (!batch.failed)
+         {
+            try
+            {
+               batch.job(i);
+            }
+            catch (...)
+            {
+               std::lock_guard<std::mutex> lock(batch.mutex);
+               if (!batch.error)
+               {
+                  batch.error = std::current_exception();
+               }
+               batch.failed = true;
+            }
+         }
+         std::lock_guard<std::mutex> lock(batch.mutex);
+         if (++batch.done == batch.count)
+         {
+            batch.finished.notify_all();
+         }
+      }
+   }
+
+   /**
+    * A worker: help with whichever batch asked first, until
+    * the pool is destroyed.
+    */
+   void serve()
+   {
+      while (true)
+      {
+         std::shared_ptr<batch_t> batch;
+         {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+            if (queue_.empty())
+            {
+               return;
+            }
+            batch = std::move(queue_.front());
+            queue_.pop_front();
+         }
+         work(*batch);
+      }
+   }
+
+   std::mutex mutex_;
+   std::condition_variable ready_;
+   // One entry per worker a batch asked for. A worker that
+   // gets to an entry after the batch is done finds no jobs
+   // left and moves on.
+   std::deque<std::shared_ptr<batch_t>> queue_;
+   bool stop_;
+   std::vector<std::thread> threads_;
+};
+
+#endif
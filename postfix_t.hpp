@@ -1,9 +1,18 @@
 #ifndef __postfix_t_hpp__
 #define __postfix_t_hpp__
 
-#include <deque>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <climits>
+#include <cstdint>
 #include <iosfwd>
-#include <unordered_map>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include <sstream>
 #include <algorithm>
 #include <boost/algorithm/string.hpp>
@@ -18,26 +27,49 @@
 #include "oct_printer_t.hpp"
 #include "commaifier_t.hpp"
 #include "constants.hpp"
+#include "value_stack_t.hpp"
+#include "factorial_t.hpp"
+#include "stats_t.hpp"
+#include "sequence_t.hpp"
+#include "tree_t.hpp"
+#include "budget_t.hpp"
+#include "num_traits_t.hpp"
+#include "op_t.hpp"
+
+template <typename number_t>
+struct basic_stack_view_t;
 
 /**
  * A postfix calculation engine.
+ * @tparam number_t the type held on the stack. Cheaper types
+ * trade precision for throughput.
  */
-struct postfix_t
+template <typename number_t>
+struct basic_postfix_t
 {
-   postfix_t()
-      :enabled_(true)
-      ,display_type_(display_types_t::dec)
+   basic_postfix_t()
+      :display_type_(display_types_t::dec)
+      ,display_digits_(0)
+      ,threads_(0)
+      ,call_limit_(256)
+      ,sequence_unchanged_(0)
+      ,calls_(0)
    {
    }
 
    /**
-    * Remove everything from the results stack.
+    * Remove everything from the results stack. The stack's
+    * storage is kept for reuse.
     */
    void clear()
    {
-      std::deque<num_t>().swap(numbers_);
+      numbers_.clear();
+      pend(sequence_t<number_t>());
    }
 
+   /**
+    * Return the stack's unused storage to the allocator.
+    */
    void shrink_to_fit()
    {
       numbers_.shrink_to_fit();
@@ -48,34 +80,29 @@ struct postfix_t
     */
    void push(const std::string& op)
    {
+      budget_t::scope_t scope(budget_);
       try
       {
-         std::string op_copy = op;
-         boost::algorithm::to_lower(op_copy);
-         auto handler = handlers_.find(op_copy);
-         if (handler != handlers_.end())
+         op_t o;
+         if (find_op(op, o))
          {
-            handler->second(*this);
+            execute(o);
             return;
          }
 
-         op_copy = remove_commas(op_copy);
-         if (check_matches_and_strip_hexadecimal(op_copy))
-         {
-            push_hexadecimal(op_copy);
-         }
-         else if (check_matches_and_strip_octal(op_copy))
-         {
-            push_octal(op_copy);
-         }
-         else if (check_matches_and_strip_binary(op_copy))
-         {
-            push_binary(op_copy);
-         }
-         else
+         if (!definition_index_.empty())
          {
-            push_decimal(op_copy);
+            auto found = definition_index_.find(boost::algorithm::to_lower_copy(op));
+            if (found != definition_index_.end())
+            {
+               call(found->second);
+               return;
+            }
          }
+
+         number_t number = parse(op);
+         materialize();
+         numbers_.push(std::move(number));
       }
       catch (std::exception& e)
       {
@@ -87,13 +114,82 @@ struct postfix_t
       }
    }
 
+   /**
+    * Apply an operator that has already been looked up.
+    */
+   void execute(op_t op)
+   {
+      budget_t::scope_t scope(budget_);
+      if (!lazy(op))
+      {
+         materialize();
+      }
+      switch (op)
+      {
+#define X(id, name) case op_t::id: op_ ## id(*this); break;
+         MANCALC_OPERATORS(X)
+#undef X
+      }
+   }
+
+   /**
+    * Interpret a number literal in any of the supported
+    * bases.
+    * @param[in] token the literal, possibly with commas and
+    * a base prefix
+    * @return the value of the literal
+    */
+   static number_t parse(const std::string& token)
+   {
+      number_t result;
+      if (parse_short(token, result))
+      {
+         return result;
+      }
+
+      std::string op_copy;
+      op_copy.reserve(token.size());
+      for (char c : token)
+      {
+         if (c != ',')
+         {
+            op_copy.push_back(std::tolower(static_cast<unsigned char>(c)));
+         }
+      }
+      if (check_matches_and_strip_hexadecimal(op_copy))
+      {
+         return parse_hexadecimal(op_copy);
+      }
+      else if (check_matches_and_strip_octal(op_copy))
+      {
+         return parse_octal(op_copy);
+      }
+      else if (check_matches_and_strip_binary(op_copy))
+      {
+         return parse_binary(op_copy);
+      }
+      return parse_decimal(op_copy);
+   }
+
    // Overloads for type safety.
-   void push(const num_t& number) { numbers_.push_back(number); }
-   void push(double number) { numbers_.push_back(number); }
-   void push(int number) { numbers_.push_back(number); }
-   void push(unsigned int number) { numbers_.push_back(number); }
-   void push(short number) { numbers_.push_back(number); }
-   void push(unsigned short number) { numbers_.push_back(number); }
+   void push(const number_t& number)
+   {
+      materialize();
+      numbers_.push(number);
+   }
+
+   void push(number_t&& number)
+   {
+      materialize();
+      numbers_.push(std::move(number));
+   }
+
+   template
+   <
+      typename scalar_t,
+      typename = std::enable_if_t<std::is_arithmetic<scalar_t>::value>
+   >
+   void push(scalar_t number) { push(number_t(number)); }
 
    void push(char op)
    {
@@ -107,1221 +203,2371 @@ struct postfix_t
       this->push(converted);
    }
 
+   /**
+    * The limits on each push or execute. Operators that loop
+    * charge it once per step. If it runs out they throw
+    * "cancelled" and leave the stack as they found it.
+    */
+   budget_t& budget()
+   {
+      return budget_;
+   }
+
    /**
     * @return the top of the stack without removing it.
     */
-   num_t top() const
+   number_t top() const
    {
-      ensure(numbers_.size() > 0);
-      return numbers_.back();
+      if (!sequence_.empty())
+      {
+         return sequence_.back();
+      }
+      return numbers_.top();
    }
 
    /**
     * @return the top of the stack and remove it.
     */
-   num_t pop()
+   number_t pop()
    {
-      num_t result = top();
-      numbers_.pop_back();
-      return result;
+      if (!sequence_.empty())
+      {
+         number_t result = sequence_.back();
+         sequence_.pop_back();
+         return result;
+      }
+      return numbers_.pop();
    }
 
    /**
-    * @return true when we can apply a ternary operation.
+    * @return how many values are on the stack, counting
+    * those of a sequence not yet pushed.
     */
-   bool can_top() const
+   std::size_t depth() const
    {
-     return numbers_.size() >= 3;
+      return numbers_.size() + sequence_.size();
    }
 
    /**
-    * @return true when we can apply a binary operation.
+    * Replace the top of the stack in place.
+    * @param[in] f called as f(number_t& x), it updates x
     */
-   bool can_bop() const
+   template <typename function_t>
+   void apply_unary(function_t f)
    {
-      return numbers_.size() >= 2;
+      ensure(can_uop());
+      f(numbers_.top());
    }
 
    /**
-    * @return true when we can apply a unary operation.
+    * Combine the top two values of the stack in place. The
+    * result replaces the lower value and the top is dropped.
+    * @param[in] f called as f(number_t& lhs, const number_t&
+    * rhs), it stores the result in lhs
     */
-   bool can_uop() const
+   template <typename function_t>
+   void apply_binary(function_t f)
    {
-      return numbers_.size() >= 1;
+      ensure(can_bop());
+      f(numbers_.top(1), numbers_.top());
+      numbers_.drop();
    }
 
    /**
-    * @return the stack rendered into a readable form.
+    * apply_unary for the operators that need fractions. An
+    * integer engine has none, so there they throw instead.
+    * @param[in] f called as f(auto& x); taking auto keeps it
+    * from being compiled for an integer number_t
     */
-   std::string str() const
+   template <typename function_t>
+   void apply_real(function_t f)
    {
-      std::stringstream ss;
-      ss << *this;
-      std::string result(ss.str());
-      return result;
+      if constexpr (is_integer)
+      {
+         throw "not an integer operator";
+      }
+      else
+      {
+         apply_unary(f);
+      }
    }
 
-private:
-   friend std::ostream& operator<<(std::ostream& o, const postfix_t& p);
-
-   make_property(bool, enabled);
-   make_property(display_types_t, display_type);
-
-   // This is not an std::stack because stacks can't iterate
-   // and I want to be able to iterate in order to print.
-   std::deque<num_t> numbers_;
-
    /**
-    * Let num_t handle the parsing.
+    * apply_binary for the operators that need fractions.
+    * @param[in] f called as f(auto& lhs, const auto& rhs)
     */
-   void push_decimal(const std::string& d)
+   template <typename function_t>
+   void apply_real_binary(function_t f)
    {
-      try
+      if constexpr (is_integer)
       {
-         num_t bignum(d);
-         numbers_.push_back(bignum);
+         throw "not an integer operator";
       }
-      catch (std::runtime_error&)
+      else
       {
-         throw "failed push";
+         apply_binary(f);
       }
    }
 
-   std::string remove_commas(const std::string& s)
+   /**
+    * Combine the top two values of the stack bit by bit, as
+    * two's complement integers.
+    * @param[in] f called as f(int_t& lhs, const int_t& rhs),
+    * it stores the result in lhs
+    * @throw "not an integer" when either value has a fraction
+    */
+   template <typename function_t>
+   void apply_bitwise(function_t f)
    {
-      std::string result = s;
-      result.erase
+      apply_binary
       (
-         std::remove(result.begin(), result.end(), ','), result.end()
+         [&f](number_t& lhs, const number_t& rhs)
+         {
+            if constexpr (is_integer)
+            {
+               f(lhs, rhs);
+            }
+            else
+            {
+               int_t result = integer(lhs);
+               f(result, integer(rhs));
+               lhs = num_traits_t<number_t>::from_int(result);
+            }
+         }
       );
-      return result;
    }
 
    /**
-    * Attempt to interpret a nondecimal number.
-    * @param[in] the nondecimal number with prefix removed.
-    * @param[in] digits the mapping of digit to value for
-    * all values in the base. Alphabetical characters should
-    * be lowercase.
+    * Replace the top arity values with whatever generate
+    * pushes. If generate throws, what it pushed is dropped
+    * and the operands are left as they were.
+    * @param[in] generate called as generate(), it pushes the
+    * replacement values. The operands may move while it runs,
+    * so it must not hold references to them.
     */
-   void push_nondecimal
-   (
-      const std::string& n,
-      const std::unordered_map<char, num_t>& digits
-   )
+   template <typename function_t>
+   void replace_operands(std::size_t arity, function_t generate)
    {
-      std::vector<std::string> components;
-      boost::split(components, n, boost::is_any_of("."), boost::token_compress_on);
-      num_t result = 0;
-      num_t multiplier = 1;
-      num_t base_multiplier = digits.size();
-      num_t divider = base_multiplier;
-      switch (components.size())
+      ensure(numbers_.size() >= arity);
+      std::size_t mark = numbers_.size();
+      try
       {
-         case 2:
+         generate();
+      }
+      catch (...)
+      {
+         numbers_.drop(numbers_.size() - mark);
+         throw;
+      }
+      numbers_.erase(numbers_.size() - mark, arity);
+   }
+
+   /**
+    * Replace the whole stack with one value computed from it.
+    * @param[in] f called as f(const value_stack_t&), it must
+    * not change the stack. A pending sequence is not in the
+    * value_stack_t, so f must take sequence_ into account.
+    */
+   template <typename function_t>
+   void reduce(function_t f)
+   {
+      number_t result = f(static_cast<const value_stack_t<number_t>&>(numbers_));
+      clear();
+      numbers_.push(std::move(result));
+   }
+
+   /**
+    * @return the sum of numbers as a pairwise tree plus the
+    * sum of the pending sequence in closed form, 0 when there
+    * are none.
+    */
+   number_t total(const value_stack_t<number_t>& numbers)
+   {
+      number_t result = sequence_.sum();
+      if (numbers.size() != 0)
+      {
+         result += tree_t<number_t>(budget_, threads_)
+         (
+            numbers.begin(),
+            numbers.end(),
+            [](number_t& lhs, const number_t& rhs)
             {
-               std::string::const_iterator i =
-                  components[1].cbegin();
-               std::string::const_iterator end =
-                  components[1].cend();
-               for (;i < end; ++i)
-               {
-                  auto p = digits.find(*i);
-                  if (p == digits.end())
-                  {
-                     throw "push_nondecimal invalid digit";
-                  }
-                  result += p->second / divider;
-                  divider *= base_multiplier;
-               }
+               lhs += rhs;
             }
-            // intentional fallthrough
-         case 1:
+         );
+      }
+      return result;
+   }
+
+   /**
+    * Push the values of the pending sequence, if there is
+    * one, so that numbers_ is the whole stack again. If the
+    * budget runs out they are dropped and the sequence is
+    * kept.
+    * @throw "sequence too long" when there are more than
+    * max_materialize values, leaving the sequence pending
+    */
+   void materialize()
+   {
+      if (sequence_.empty())
+      {
+         return;
+      }
+      if (sequence_.size() > max_materialize)
+      {
+         throw "sequence too long";
+      }
+      budget_t::scope_t scope(budget_);
+      const std::size_t mark = numbers_.size();
+      const std::size_t same = unchanged();
+      try
+      {
+         numbers_.reserve(mark + sequence_.size());
+         for (std::size_t i = 0; i < sequence_.size(); ++i)
+         {
+            // The steps were charged when the sequence was
+            // made.
+            if (i % materialize_stride == 0)
             {
-               std::string::const_iterator i =
-                  components[0].cend() - 1;
-               std::string::const_iterator begin =
-                  components[0].cbegin();
-               for (; begin <= i; --i)
-               {
-                  auto p = digits.find(*i);
-                  if (p == digits.end())
-                  {
-                     throw "push_nondecimal invalid digit";
-                  }
-                  result += multiplier * p->second;
-                  multiplier *= base_multiplier;
-               }
+               budget_.check();
             }
-            break;
-         case 0:
-            throw "push_nondecimal no components";
-         default:
-            throw "push_nondecimal too many components";
+            numbers_.push(sequence_[i]);
+         }
+      }
+      catch (...)
+      {
+         numbers_.drop(numbers_.size() - mark);
+         throw;
       }
-      numbers_.push_back(result);
+      // The values are the ones that were pending, so a view
+      // needn't render them again.
+      numbers_.mark_unchanged(same);
+      pend(sequence_t<number_t>());
    }
 
-   std::unordered_map<char, num_t> hex_digits =
+   /**
+    * The stack before a line of several pushes: the bottom
+    * of it, which the line is expected to leave alone, and a
+    * copy of the rest.
+    */
+   struct checkpoint_t
    {
-      {'0', 0}, {'1', 1}, {'2', 2}, {'3', 3},
-      {'4', 4}, {'5', 5}, {'6', 6}, {'7', 7},
-      {'8', 8}, {'9', 9}, {'a', 10}, {'b', 11},
-      {'c', 12}, {'d', 13}, {'e', 14}, {'f', 15},
+      std::size_t base;
+      std::vector<number_t> values;
+      sequence_t<number_t> sequence;
    };
+
+   // How many values from the top a checkpoint copies.
+   static constexpr std::size_t checkpoint_values = 64;
+
    /**
-    * @param[in] a hexidecimal number string
+    * @return what restore() needs to put the stack back as
+    * it is now. Only values unchanged since mark_unchanged()
+    * can be told apart from changed ones later, so the rest
+    * are copied even when there are more than
+    * checkpoint_values of them.
     */
-   void push_hexadecimal(const std::string& x)
+   checkpoint_t checkpoint() const
    {
-      push_nondecimal(x, hex_digits);
+      const std::size_t size = numbers_.size();
+      checkpoint_t result;
+      result.base = std::min(numbers_.unchanged(), size - std::min(size, checkpoint_values));
+      for (std::size_t i = result.base; i < size; ++i)
+      {
+         result.values.push_back(numbers_.top(size - 1 - i));
+      }
+      result.sequence = sequence_;
+      return result;
    }
 
-   std::unordered_map<char, num_t> oct_digits =
+   /**
+    * Put the stack back as it was at checkpoint, for a line
+    * that was cancelled part way.
+    * @return false, leaving the stack as it is, when the line
+    * changed values below the ones checkpoint copied
+    */
+   bool restore(const checkpoint_t& checkpoint)
    {
-      {'0', 0}, {'1', 1}, {'2', 2}, {'3', 3},
-      {'4', 4}, {'5', 5}, {'6', 6}, {'7', 7},
-   };
+      if (numbers_.unchanged() < checkpoint.base)
+      {
+         return false;
+      }
+      numbers_.drop(numbers_.size() - checkpoint.base);
+      for (const number_t& value : checkpoint.values)
+      {
+         numbers_.push(value);
+      }
+      pend(checkpoint.sequence);
+      return true;
+   }
+
    /**
-    * @param[in] an octal number string
+    * @return true when op can work on a pending sequence
+    * without its values being pushed first.
     */
-   void push_octal(const std::string& o)
+   static constexpr bool lazy(op_t op)
    {
-      push_nondecimal(o, oct_digits);
+      switch (op)
+      {
+         case op_t::sum:
+         case op_t::prod:
+         case op_t::avg:
+         case op_t::stddev:
+         case op_t::stats:
+         case op_t::clear:
+         case op_t::clr:
+         case op_t::pop:
+         case op_t::p:
+         case op_t::dec:
+         case op_t::eng:
+         case op_t::com:
+         case op_t::hex:
+         case op_t::oct:
+         case op_t::bin:
+            return true;
+         default:
+            return false;
+      }
    }
-   
-   std::unordered_map<char, num_t> bin_digits =
+
+   /**
+    * Replace the operands of a sequence operator with a
+    * pending sequence, charging the budget a step per value
+    * as though they had been pushed.
+    */
+   void replace_with_sequence(std::size_t arity, const sequence_t<number_t>& sequence)
    {
-      {'0', 0}, {'1', 1},
-   };
+      ensure(numbers_.size() >= arity);
+      budget_.charge(sequence.size());
+      numbers_.drop(arity);
+      pend(sequence);
+   }
+
+   void pend(const sequence_t<number_t>& sequence)
+   {
+      sequence_ = sequence;
+      sequence_unchanged_ = 0;
+   }
+
    /**
-    * @param[in] a binary number string
+    * @param[in] index how far above the bottom, 0 is the
+    * bottom
+    * @return a value on the stack, pending or not
     */
-   void push_binary(const std::string& b)
+   number_t at(std::size_t index) const
    {
-      push_nondecimal(b, bin_digits);
+      if (index < numbers_.size())
+      {
+         return numbers_.top(numbers_.size() - 1 - index);
+      }
+      return sequence_[index - numbers_.size()];
    }
 
    /**
-    * Check a string to see if it begins with any of the
-    * candidate prefixes and remove it. The first matched
-    * prefix ends the operation.
-    * @param[in] candidate_prefixes the set of prefixes
-    * @param[in] s the string to check
-    * @return true if one of the prefixes matched and was
-    * removed.
+    * value_stack_t::unchanged() for the whole stack, a
+    * pending sequence included.
     */
-   bool check_matches_and_strip_prefix
-   (
-      const std::vector<std::string>& candidate_prefixes,
-      std::string& s
-   )
+   std::size_t unchanged() const
    {
-      bool result = false;
-      for (auto prefix : candidate_prefixes)
+      if (numbers_.unchanged() < numbers_.size())
       {
-         result = result || boost::starts_with(s, prefix);
-         if (result)
-         {
-            s.erase(0, prefix.size());
-            break;
-         }
+         return numbers_.unchanged();
       }
-      return result;
+      return numbers_.size() + std::min(sequence_unchanged_, sequence_.size());
    }
 
-   std::vector<std::string> hex_prefixes = 
+   void mark_unchanged()
    {
-      "x", "h", "0x", "0h"
-   };
+      numbers_.mark_unchanged();
+      sequence_unchanged_ = sequence_.size();
+   }
+
    /**
-    * Checks to see if a number is marked with a hexadecimal
-    * prefix and removes it.
-    * @param[in] x the potential hexadecimal number
-    * @return true if x was hexadecimal
+    * @return true when we can apply a ternary operation.
     */
-   bool check_matches_and_strip_hexadecimal(std::string& x)
+   bool can_top() const
    {
-      bool result = check_matches_and_strip_prefix(hex_prefixes, x);
-      return result;
+     return depth() >= 3;
    }
 
-   std::vector<std::string> octal_prefixes =
+   /**
+    * @return true when we can apply a binary operation.
+    */
+   bool can_bop() const
    {
-      "o", "0o"
-   };
+      return depth() >= 2;
+   }
+
    /**
-    * Checks to see if a number is marked with a octal
-    * prefix and removes it.
-    * @param[in] x the potential octal number
-    * @return true if x was octal
+    * @return true when we can apply a unary operation.
     */
-   bool check_matches_and_strip_octal(std::string& o)
+   bool can_uop() const
    {
-      bool result = check_matches_and_strip_prefix(octal_prefixes, o);
-      return result;
+      return depth() >= 1;
    }
 
-   std::vector<std::string> binary_prefixes =
+   /**
+    * @return n as it is displayed in mode, grouping the
+    * integer digits in com mode. In dec, eng and com mode
+    * only digits significant digits are generated, or all of
+    * them (eng's usual 6) when digits is 0.
+    */
+   static std::string format
+   (
+      const number_t& n,
+      display_types_t mode,
+      const commaifier_t& grouping = commaifier_t(),
+      std::size_t digits = 0
+   )
    {
-      "b", "0b"
-   };
+      static hex_printer_t hex_printer;
+      static oct_printer_t oct_printer;
+      static bin_printer_t bin_printer;
+
+      switch (mode)
+      {
+         case display_types_t::hex:
+            return hex_printer.convert(n);
+         case display_types_t::oct:
+            return oct_printer.convert(n);
+         case display_types_t::bin:
+            return bin_printer.convert(n);
+         case display_types_t::eng:
+            {
+               std::ostringstream ss;
+               if (digits != 0)
+               {
+                  ss.precision(digits);
+               }
+               ss << n;
+               return ss.str();
+            }
+         case display_types_t::com:
+            return grouping.str(num_traits_t<number_t>::str(n, digits));
+         case display_types_t::dec:
+         default:
+            return num_traits_t<number_t>::str(n, digits);
+      }
+   }
+
    /**
-    * Checks to see if a number is marked with a binary
-    * prefix and removes it.
-    * @param[in] x the potential binary number
-    * @return true if x was binary
+    * @return the stack rendered into a readable form.
     */
-   bool check_matches_and_strip_binary(std::string& b)
+   std::string str() const
    {
-      bool result = check_matches_and_strip_prefix(binary_prefixes, b);
+      std::stringstream ss;
+      ss << *this;
+      std::string result(ss.str());
       return result;
    }
+
    /**
-    * The operators.
+    * Define name as the postfix tokens of body. Each token is
+    * looked up now, as an operator, a definition or a number,
+    * so calling name runs the steps without parsing anything.
+    * Calls to definitions, name itself included, go by name:
+    * they see a later redefinition and fail once it is
+    * removed.
+    * @throw a const char* when name is taken by an operator
+    * or a number or a token is none of the three. Any earlier
+    * definition of name is left as it was.
     */
-   std::unordered_map
-   <
-      std::string,
-      std::function<void(postfix_t&)>
-   > handlers_ =
+   void define(const std::string& name, const std::string& body)
    {
+      const std::string lowered = boost::algorithm::to_lower_copy(name);
+      op_t op;
+      if (lowered.empty() || find_op(lowered, op) || is_number(lowered))
       {
-         "+",
-         [](postfix_t& p)
-         {
-            ensure(p.can_bop());
-            num_t rhs = p.pop();
-            num_t lhs = p.pop();
-            num_t result = lhs + rhs;
-            p.push(result);
-         }
-      },
+         throw "not a name for a definition";
+      }
+      auto slot = definition_index_.find(lowered);
+      if (slot == definition_index_.end())
+      {
+         slot = definition_index_.emplace(lowered, definitions_.size()).first;
+         definitions_.emplace_back();
+      }
+
+      definition_t result;
+      std::istringstream tokens(body);
+      std::string token;
+      while (tokens >> token)
       {
-         "-",
-         [](postfix_t& p)
+         if (!result.body.empty())
          {
-            ensure(p.can_bop());
-            num_t rhs = p.pop();
-            num_t lhs = p.pop();
-            num_t result = lhs - rhs;
-            p.push(result);
+            result.body += ' ';
          }
-      },
-      {
-         "*",
-         [](postfix_t& p)
+         result.body += token;
+
+         if (find_op(token, op))
          {
-            ensure(p.can_bop());
-            num_t rhs = p.pop();
-            num_t lhs = p.pop();
-            num_t result = lhs * rhs;
-            p.push(result);
+            result.steps.push_back({step_t::kind_t::op, static_cast<std::size_t>(op)});
+            continue;
          }
-      },
-      {
-         "/",
-         [](postfix_t& p)
+         auto called = definition_index_.find(boost::algorithm::to_lower_copy(token));
+         if
+         (
+            called != definition_index_.end()
+            && (definitions_[called->second].defined || called == slot)
+         )
          {
-            ensure(p.can_bop());
-            num_t rhs = p.pop();
-            num_t lhs = p.pop();
-            num_t result = lhs / rhs;
-            p.push(result);
+            result.steps.push_back({step_t::kind_t::call, called->second});
+            continue;
          }
-      },
-      {
-         "%",
-         [](postfix_t& p)
+         if (!is_number(token))
          {
-            ensure(p.can_bop());
-            num_t rhs = p.pop();
-            num_t lhs = p.pop();
-            num_t result = fmod(lhs, rhs);
-            p.push(result);
+            throw "not an operator, number or definition";
          }
-      },
+         result.steps.push_back({step_t::kind_t::constant, result.constants.size()});
+         result.constants.push_back(parse(token));
+      }
+      if (result.steps.empty())
       {
-         "<<",
-         [](postfix_t& p)
-         {
-            ensure(p.can_bop());
-            num_t rhs = p.pop();
-            num_t orig_rhs = rhs;
-            num_t lhs = p.pop();
-            num_t orig_lhs = lhs;
-            num_t result = lhs;
-            while (p.enabled() && rhs > 0)
-            {
-               result *= 2;
-               --rhs;
+         throw "empty definition";
+      }
+      result.defined = true;
+      definitions_[slot->second] = std::move(result);
+   }
+
+   /**
+    * Remove name's definition.
+    * @return false when there was none
+    */
+   bool undefine(const std::string& name)
+   {
+      auto slot = definition_index_.find(boost::algorithm::to_lower_copy(name));
+      if (slot == definition_index_.end() || !definitions_[slot->second].defined)
+      {
+         return false;
+      }
+      // The slot stays so that the definitions calling this
+      // one still refer to it, should it come back.
+      definitions_[slot->second] = definition_t();
+      return true;
+   }
+
+   /**
+    * @return true when name has a definition.
+    */
+   bool defined(const std::string& name) const
+   {
+      auto slot = definition_index_.find(boost::algorithm::to_lower_copy(name));
+      return slot != definition_index_.end() && definitions_[slot->second].defined;
+   }
+
+   /**
+    * @return each definition's name and body, by name.
+    */
+   std::vector<std::pair<std::string, std::string>> definitions() const
+   {
+      std::vector<std::pair<std::string, std::string>> result;
+      for (const auto& slot : definition_index_)
+      {
+         const definition_t& definition = definitions_[slot.second];
+         if (definition.defined)
+         {
+            result.emplace_back(slot.first, definition.body);
+         }
+      }
+      return result;
+   }
+
+   // The most values materialize() will push, 256 MiB of
+   // them: 32 Mi doubles or about half a million dec1024
+   // numbers. A longer sequence can only be reduced or
+   // dropped.
+   static constexpr std::size_t max_materialize = (std::size_t(1) << 28) / sizeof(number_t);
+
+private:
+   template <typename other_t>
+   friend struct basic_stack_view_t;
+
+   // An integer engine, such as one over int_t, has no
+   // fractions: division truncates, shifts and the bitwise
+   // operators work on the value directly and the operators
+   // that need fractions throw.
+   static constexpr bool is_integer = std::numeric_limits<number_t>::is_integer;
+
+   // How many values materialize() pushes between looks at
+   // the budget.
+   static constexpr std::size_t materialize_stride = 1024;
+
+   template <typename other_t>
+   friend std::ostream& operator<<
+   (
+      std::ostream& o,
+      const basic_postfix_t<other_t>& p
+   );
+
+   make_property(display_types_t, display_type);
+
+   // How com mode groups digits.
+   make_property(commaifier_t, grouping);
+
+   // How many significant digits to show, 0 for all.
+   make_property(std::size_t, display_digits);
+
+   // How many threads sum, prod and avg may use, 0 for one
+   // per core.
+   make_property(std::size_t, threads);
+
+   // How deeply definitions may call one another, a
+   // definition calling itself included.
+   make_property(std::size_t, call_limit);
+
+   // This is not an std::stack because stacks can't iterate
+   // and I want to be able to iterate in order to print.
+   value_stack_t<number_t> numbers_;
+
+   // seq0 - seq3 leave their values here rather than on
+   // numbers_. It is the top of the stack, above numbers_,
+   // and the operators that can't work on it directly have
+   // its values pushed first.
+   sequence_t<number_t> sequence_;
+
+   // How many of sequence_'s values, from the bottom, haven't
+   // changed since mark_unchanged(). Values only ever leave a
+   // sequence from the top, so it is a count like
+   // value_stack_t's.
+   std::size_t sequence_unchanged_;
+
+   factorial_t<number_t> factorial_;
+
+   budget_t budget_;
+
+   /**
+    * One resolved token of a definition.
+    */
+   struct step_t
+   {
+      enum class kind_t : std::uint8_t
+      {
+         constant,
+         op,
+         call,
+      };
+
+      kind_t kind;
+      // The constant's index, the op_t or the definition's
+      // slot.
+      std::size_t operand;
+   };
+
+   struct definition_t
+   {
+      // The tokens as they were given, for listing.
+      std::string body;
+      std::vector<step_t> steps;
+      std::vector<number_t> constants;
+      bool defined = false;
+   };
+
+   // The definitions by lowercase name. A removed one keeps
+   // its slot in definitions_, undefined.
+   std::map<std::string, std::size_t> definition_index_;
+   std::vector<definition_t> definitions_;
+
+   // How deeply definitions are calling one another now.
+   std::size_t calls_;
+
+   /**
+    * Run the definition in slot, charging the budget a step.
+    * A call that fails part way leaves the stack as its
+    * steps so far left it, as a line of tokens would.
+    */
+   void call(std::size_t slot)
+   {
+      const definition_t& definition = definitions_[slot];
+      if (!definition.defined)
+      {
+         throw "not defined";
+      }
+      if (calls_ >= call_limit_)
+      {
+         throw "too many nested calls";
+      }
+      budget_.charge();
+      ++calls_;
+      try
+      {
+         for (const step_t& step : definition.steps)
+         {
+            switch (step.kind)
+            {
+               case step_t::kind_t::constant:
+                  push(definition.constants[step.operand]);
+                  break;
+               case step_t::kind_t::op:
+                  execute(static_cast<op_t>(step.operand));
+                  break;
+               case step_t::kind_t::call:
+                  call(step.operand);
+                  break;
+            }
+         }
+      }
+      catch (...)
+      {
+         --calls_;
+         throw;
+      }
+      --calls_;
+   }
+
+   /**
+    * @return true when token reads as a number.
+    */
+   static bool is_number(const std::string& token)
+   {
+      try
+      {
+         parse(token);
+         return true;
+      }
+      catch (const char*)
+      {
+      }
+      catch (const std::exception&)
+      {
+      }
+      return false;
+   }
+
+   /**
+    * Let number_t handle the parsing.
+    */
+   static number_t parse_decimal(const std::string& d)
+   {
+      try
+      {
+         number_t bignum = num_traits_t<number_t>::parse(d);
+         return bignum;
+      }
+      catch (std::runtime_error&)
+      {
+         throw "failed push";
+      }
+   }
+
+   /**
+    * @return the number of places rhs shifts by. Like the
+    * doubling loops this replaces, a fractional count rounds
+    * up and a negative one is zero.
+    */
+   static int shift_count(const number_t& rhs)
+   {
+      number_t count = rhs;
+      if constexpr (!is_integer)
+      {
+         count = ceil(rhs);
+      }
+      if (!(count > 0))
+      {
+         return 0;
+      }
+      if (count > std::numeric_limits<int>::max())
+      {
+         return std::numeric_limits<int>::max();
+      }
+      return static_cast<int>(count);
+   }
+
+   /**
+    * Multiply by 2^places in one step rather than one
+    * doubling or halving at a time. Scaling by a power of two
+    * is exact in binary and ldexp does it directly. A decimal
+    * number_t multiplies exactly too, and divides exactly by
+    * a power of two that fits in a limb, but beyond that it
+    * halves by multiplying by 5^k and 10^-k, both of which it
+    * represents exactly.
+    */
+   static number_t shift(const number_t& n, int places)
+   {
+      if constexpr (std::numeric_limits<number_t>::radix == 2)
+      {
+         return ldexp(n, places);
+      }
+      else
+      {
+         if (places >= -26)
+         {
+            return ldexp(n, places);
+         }
+         number_t five = pow(number_t(5), -places);
+         if (!boost::math::isfinite(five))
+         {
+            return ldexp(n, places);
+         }
+         return n * five * number_t("1e" + std::to_string(places));
+      }
+   }
+
+   // The most bits an integer engine will make a shift or a
+   // power produce, 2 MiB worth. Beyond that printing alone
+   // takes longer than anyone will wait.
+   static constexpr std::size_t max_integer_bits = std::size_t(1) << 24;
+
+   /**
+    * @throw "integer too large" when bits is more than an
+    * integer engine will hold
+    */
+   static void ensure_integer_bits(const int_t& bits)
+   {
+      if (bits > max_integer_bits)
+      {
+         throw "integer too large";
+      }
+   }
+
+   /**
+    * @return true when n is a finite whole number.
+    */
+   static bool whole(const number_t& n)
+   {
+      if constexpr (is_integer)
+      {
+         return true;
+      }
+      else
+      {
+         return boost::math::isfinite(n) && n == floor(n);
+      }
+   }
+
+   /**
+    * @return n as an int_t, for the bitwise operators.
+    * @throw "not an integer" when n has a fraction
+    */
+   static int_t integer(const number_t& n)
+   {
+      if constexpr (is_integer)
+      {
+         return n;
+      }
+      else
+      {
+         if (!whole(n))
+         {
+            throw "not an integer";
+         }
+         if (n < 0)
+         {
+            return -num_traits_t<number_t>::to_int(-n);
+         }
+         return num_traits_t<number_t>::to_int(n);
+      }
+   }
+
+   static constexpr std::size_t short_digits = 18;
+
+   static constexpr std::size_t max_display_digits = 100000;
+
+   // The widest group of digits com mode will make.
+   static constexpr std::size_t max_group = 64;
+
+   /**
+    * Read the common literals without building a std::string:
+    * an optional minus sign and up to short_digits decimal
+    * digits, with commas and at most one point, classified
+    * in one pass into a buffer on the stack. Integers fit in
+    * an int64_t. A decimal number_t parses a fraction itself,
+    * which costs less than scaling by a power of ten at 1024
+    * digits; a binary one divides by the power of ten with a
+    * single rounding and double uses from_chars. Anything
+    * else is left to the general parse.
+    * @return true if s was a short literal, now in result
+    */
+   static bool parse_short(std::string_view s, number_t& result)
+   {
+      char text[short_digits + 3];
+      std::size_t length = 0;
+      std::int64_t mantissa = 0;
+      std::size_t digits = 0;
+      std::size_t places = 0;
+      bool point = false;
+      const bool negative = !s.empty() && s.front() == '-';
+      if (negative)
+      {
+         text[length++] = '-';
+         s.remove_prefix(1);
+      }
+      for (char c : s)
+      {
+         if (c >= '0' && c <= '9')
+         {
+            if (++digits > short_digits)
+            {
+               return false;
+            }
+            mantissa = mantissa * 10 + (c - '0');
+            places += point;
+         }
+         else if (c == '.' && !point)
+         {
+            point = true;
+         }
+         else if (c != ',')
+         {
+            return false;
+         }
+         if (c != ',')
+         {
+            text[length++] = c;
+         }
+      }
+      text[length] = '\0';
+      // Leave -0 to number_t, which knows whether it has one.
+      if (digits == 0 || (negative && mantissa == 0))
+      {
+         return false;
+      }
+
+      if constexpr (std::is_same_v<number_t, double>)
+      {
+         auto r = std::from_chars(text, text + length, result);
+         return r.ec == std::errc() && r.ptr == text + length;
+      }
+      else if constexpr (is_integer)
+      {
+         // The general parse turns a fraction away.
+         if (places != 0)
+         {
+            return false;
+         }
+         result = number_t(negative ? -mantissa : mantissa);
+         return true;
+      }
+      else if constexpr (std::numeric_limits<number_t>::radix == 10)
+      {
+         result = places == 0
+            ? number_t(negative ? -mantissa : mantissa)
+            : number_t(text);
+         return true;
+      }
+      else
+      {
+         result = number_t(mantissa) / number_t(powers_of_ten[places]);
+         if (negative)
+         {
+            result = -result;
+         }
+         return true;
+      }
+   }
+
+   static constexpr std::array<std::uint64_t, short_digits + 1> make_powers_of_ten()
+   {
+      std::array<std::uint64_t, short_digits + 1> result{};
+      result[0] = 1;
+      for (std::size_t i = 1; i < result.size(); ++i)
+      {
+         result[i] = result[i - 1] * 10;
+      }
+      return result;
+   }
+
+   static constexpr std::array<std::uint64_t, short_digits + 1> powers_of_ten =
+      make_powers_of_ten();
+
+   /**
+    * @return the value of each digit character, 0xff for
+    * characters that are not digits.
+    */
+   static constexpr std::array<std::uint8_t, 256> make_digit_values()
+   {
+      std::array<std::uint8_t, 256> result{};
+      for (auto& value : result)
+      {
+         value = 0xff;
+      }
+      for (int c = '0'; c <= '9'; ++c)
+      {
+         result[c] = c - '0';
+      }
+      for (int c = 'a'; c <= 'f'; ++c)
+      {
+         result[c] = c - 'a' + 10;
+      }
+      return result;
+   }
+
+   static constexpr std::array<std::uint8_t, 256> digit_values =
+      make_digit_values();
+
+   /**
+    * Pack digits straight into the limbs of an int_t, bits
+    * at a time from the least significant end, so the cost
+    * is linear in the number of digits.
+    */
+   static int_t pack_digits
+   (
+      std::string::const_iterator begin,
+      std::string::const_iterator end,
+      unsigned bits
+   )
+   {
+      using limb_type = boost::multiprecision::limb_type;
+      constexpr unsigned limb_bits = sizeof(limb_type) * CHAR_BIT;
+
+      const std::size_t count = end - begin;
+      const unsigned limb_count = static_cast<unsigned>
+      (
+         std::max<std::size_t>(1, (count * bits + limb_bits - 1) / limb_bits)
+      );
+      int_t result;
+      auto& backend = result.backend();
+      backend.resize(limb_count, limb_count);
+      ensure(backend.size() == limb_count);
+      limb_type* limbs = backend.limbs();
+      std::fill(limbs, limbs + limb_count, 0);
+
+      std::size_t bit = 0;
+      for (auto i = end; i != begin; bit += bits)
+      {
+         limb_type digit = digit_values[static_cast<unsigned char>(*--i)];
+         if (digit >> bits)
+         {
+            throw "parse_nondecimal invalid digit";
+         }
+         const std::size_t limb = bit / limb_bits;
+         const unsigned offset = bit % limb_bits;
+         limbs[limb] |= digit << offset;
+         if (offset + bits > limb_bits)
+         {
+            limbs[limb + 1] |= digit >> (limb_bits - offset);
+         }
+      }
+      backend.normalize();
+      return result;
+   }
+
+   /**
+    * Attempt to interpret a nondecimal number. The integer
+    * part is packed into an int_t; a fraction is packed the
+    * same way and scaled into number_t once at the end.
+    * @param[in] n the nondecimal number with prefix removed.
+    * Alphabetical characters should be lowercase.
+    * @param[in] bits the number of bits in one digit
+    */
+   static number_t parse_nondecimal(const std::string& n, unsigned bits)
+   {
+      const std::size_t point = n.find('.');
+      const auto whole_end = point == std::string::npos ? n.end() : n.begin() + point;
+      if (point != std::string::npos && n.find('.', point + 1) != std::string::npos)
+      {
+         throw "parse_nondecimal too many components";
+      }
+
+      number_t result =
+         num_traits_t<number_t>::from_int(pack_digits(n.begin(), whole_end, bits));
+      if (whole_end == n.end() || whole_end + 1 == n.end())
+      {
+         return result;
+      }
+
+      // fraction / 2^scale is fraction * 5^scale / 10^scale:
+      // exact in decimal as well as binary.
+      const int_t fraction = pack_digits(whole_end + 1, n.end(), bits);
+      const unsigned scale = static_cast<unsigned>((n.end() - whole_end - 1) * bits);
+      if constexpr (is_integer)
+      {
+         throw "parse_nondecimal fraction of an integer";
+      }
+      else if constexpr (std::numeric_limits<number_t>::radix == 10)
+      {
+         const int_t digits = fraction * boost::multiprecision::pow(int_t(5), scale);
+         result += number_t(digits.str() + "e-" + std::to_string(scale));
+      }
+      else
+      {
+         result += ldexp(num_traits_t<number_t>::from_int(fraction), -static_cast<int>(scale));
+      }
+      return result;
+   }
+
+   /**
+    * @param[in] a hexadecimal number string
+    */
+   static number_t parse_hexadecimal(const std::string& x)
+   {
+      return parse_nondecimal(x, 4);
+   }
+
+   /**
+    * @param[in] an octal number string
+    */
+   static number_t parse_octal(const std::string& o)
+   {
+      return parse_nondecimal(o, 3);
+   }
+
+   /**
+    * @param[in] a binary number string
+    */
+   static number_t parse_binary(const std::string& b)
+   {
+      return parse_nondecimal(b, 1);
+   }
+
+   /**
+    * Check a string to see if it begins with any of the
+    * candidate prefixes and remove it. The first matched
+    * prefix ends the operation.
+    * @param[in] candidate_prefixes the set of prefixes
+    * @param[in] s the string to check
+    * @return true if one of the prefixes matched and was
+    * removed.
+    */
+   template <std::size_t count>
+   static bool check_matches_and_strip_prefix
+   (
+      const std::array<std::string_view, count>& candidate_prefixes,
+      std::string& s
+   )
+   {
+      for (std::string_view prefix : candidate_prefixes)
+      {
+         if (std::string_view(s).substr(0, prefix.size()) == prefix)
+         {
+            s.erase(0, prefix.size());
+            return true;
+         }
+      }
+      return false;
+   }
+
+   static constexpr std::array<std::string_view, 4> hex_prefixes =
+   {
+      "x", "h", "0x", "0h"
+   };
+   /**
+    * Checks to see if a number is marked with a hexadecimal
+    * prefix and removes it.
+    * @param[in] x the potential hexadecimal number
+    * @return true if x was hexadecimal
+    */
+   static bool check_matches_and_strip_hexadecimal(std::string& x)
+   {
+      bool result = check_matches_and_strip_prefix(hex_prefixes, x);
+      return result;
+   }
+
+   static constexpr std::array<std::string_view, 2> octal_prefixes =
+   {
+      "o", "0o"
+   };
+   /**
+    * Checks to see if a number is marked with a octal
+    * prefix and removes it.
+    * @param[in] x the potential octal number
+    * @return true if x was octal
+    */
+   static bool check_matches_and_strip_octal(std::string& o)
+   {
+      bool result = check_matches_and_strip_prefix(octal_prefixes, o);
+      return result;
+   }
+
+   static constexpr std::array<std::string_view, 2> binary_prefixes =
+   {
+      "b", "0b"
+   };
+   /**
+    * Checks to see if a number is marked with a binary
+    * prefix and removes it.
+    * @param[in] x the potential binary number
+    * @return true if x was binary
+    */
+   static bool check_matches_and_strip_binary(std::string& b)
+   {
+      bool result = check_matches_and_strip_prefix(binary_prefixes, b);
+      return result;
+   }
+
+   /**
+    * The operators, one per entry in MANCALC_OPERATORS.
+    */
+   static void op_add(basic_postfix_t& p)
+   {
+      p.apply_binary
+      (
+         [](number_t& lhs, const number_t& rhs)
+         {
+            lhs += rhs;
+         }
+      );
+   }
+
+   static void op_subtract(basic_postfix_t& p)
+   {
+      p.apply_binary
+      (
+         [](number_t& lhs, const number_t& rhs)
+         {
+            lhs -= rhs;
+         }
+      );
+   }
+
+   static void op_multiply(basic_postfix_t& p)
+   {
+      p.apply_binary
+      (
+         [](number_t& lhs, const number_t& rhs)
+         {
+            lhs *= rhs;
+         }
+      );
+   }
+
+   static void op_divide(basic_postfix_t& p)
+   {
+      p.apply_binary
+      (
+         [](number_t& lhs, const number_t& rhs)
+         {
+            if constexpr (is_integer)
+            {
+               if (rhs == 0)
+               {
+                  throw "division by zero";
+               }
             }
-            if (p.enabled())
+            lhs /= rhs;
+         }
+      );
+   }
+
+   static void op_modulo(basic_postfix_t& p)
+   {
+      p.apply_binary
+      (
+         [](number_t& lhs, const number_t& rhs)
+         {
+            if constexpr (is_integer)
+            {
+               if (rhs == 0)
+               {
+                  throw "division by zero";
+               }
+               lhs %= rhs;
+            }
+            else
             {
-               p.push(result);
+               lhs = fmod(lhs, rhs);
+            }
+         }
+      );
+   }
+
+   static void op_shift_left(basic_postfix_t& p)
+   {
+      p.apply_binary
+      (
+         [](number_t& lhs, const number_t& rhs)
+         {
+            if constexpr (is_integer)
+            {
+               const int places = shift_count(rhs);
+               if (lhs != 0)
+               {
+                  ensure_integer_bits(msb(abs(lhs)) + 1 + places);
+               }
+               lhs <<= places;
             }
             else
             {
-               p.push(orig_lhs);
-               p.push(orig_rhs);
+               lhs = shift(lhs, shift_count(rhs));
             }
          }
-      },
-      {
-         ">>",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_shift_right(basic_postfix_t& p)
+   {
+      p.apply_binary
+      (
+         [](number_t& lhs, const number_t& rhs)
          {
-            ensure(p.can_bop());
-            num_t rhs = p.pop();
-            num_t orig_rhs = rhs;
-            num_t lhs = p.pop();
-            num_t orig_lhs = lhs;
-            num_t result = lhs;
-            while (p.enabled() && rhs > 0)
-            {
-               result /= 2;
-               --rhs;
-            }
-            if (p.enabled())
+            if constexpr (is_integer)
             {
-               p.push(result);
+               // Rounds toward minus infinity, as two's
+               // complement does.
+               lhs >>= shift_count(rhs);
             }
             else
             {
-               p.push(orig_lhs);
-               p.push(orig_rhs);
+               lhs = shift(lhs, -shift_count(rhs));
             }
          }
-      },
-      {
-         "^",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_bit_and(basic_postfix_t& p)
+   {
+      p.apply_bitwise
+      (
+         [](int_t& lhs, const int_t& rhs)
          {
-            ensure(p.can_bop());
-            num_t rhs = p.pop();
-            num_t lhs = p.pop();
-            num_t result = pow(lhs, rhs);
-            p.push(result);
+            lhs &= rhs;
          }
-      },
-      {
-         "!",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_bit_or(basic_postfix_t& p)
+   {
+      p.apply_bitwise
+      (
+         [](int_t& lhs, const int_t& rhs)
+         {
+            lhs |= rhs;
+         }
+      );
+   }
+
+   // ^ is already the power.
+   static void op_bit_xor(basic_postfix_t& p)
+   {
+      p.apply_bitwise
+      (
+         [](int_t& lhs, const int_t& rhs)
+         {
+            lhs ^= rhs;
+         }
+      );
+   }
+
+   /**
+    * Two's complement, so ~x is -x - 1.
+    */
+   static void op_bit_not(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t orig_rhs = rhs;
-            num_t result = 1;
-            if (rhs == 0)
+            if constexpr (is_integer)
             {
-               p.push(result);
-               return;
+               rhs = ~rhs;
             }
-            while
-            (
-               p.enabled()
-               &&
-               rhs > 1
-               && boost::math::isfinite(result)
-            )
+            else
             {
-               result *= rhs;
-               --rhs;
+               integer(rhs);
+               rhs = -rhs - 1;
             }
-            if (p.enabled())
+         }
+      );
+   }
+
+   /**
+    * The number of one bits, counted a limb at a time.
+    */
+   static void op_popcount(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
+         {
+            const int_t i = integer(rhs);
+            if (i < 0)
             {
-               p.push(result);
+               throw "popcount of a negative integer";
             }
-            else
+            const auto& backend = i.backend();
+            std::size_t count = 0;
+            for (std::size_t limb = 0; limb < backend.size(); ++limb)
             {
-               p.push(orig_rhs);
+               count += __builtin_popcountll(backend.limbs()[limb]);
             }
+            rhs = count;
          }
-      },
-      {
-         "++",
-         [](postfix_t& p)
+      );
+   }
+
+   /**
+    * The number of leading zero bits in the 64 bit words that
+    * hold the value, so it matches a machine clz for anything
+    * that fits in one. 0 has 64.
+    */
+   static void op_clz(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = rhs + 1;
-            p.push(result);
+            constexpr unsigned word_bits = 64;
+            const int_t i = integer(rhs);
+            if (i < 0)
+            {
+               throw "clz of a negative integer";
+            }
+            rhs = i == 0 ? word_bits : word_bits - 1 - msb(i) % word_bits;
          }
-      },
-      {
-         "--",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_power(basic_postfix_t& p)
+   {
+      p.apply_binary
+      (
+         [](number_t& lhs, const number_t& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = rhs - 1;
-            p.push(result);
+            if constexpr (is_integer)
+            {
+               if (rhs < 0)
+               {
+                  throw "negative power of an integer";
+               }
+               if (abs(lhs) > 1)
+               {
+                  ensure_integer_bits((msb(abs(lhs)) + 1) * rhs);
+                  lhs = pow(lhs, static_cast<unsigned>(rhs));
+               }
+               else if (rhs == 0 || (lhs == -1 && rhs % 2 == 0))
+               {
+                  lhs = 1;
+               }
+            }
+            else
+            {
+               lhs = pow(lhs, rhs);
+            }
          }
-      },
-      {
-         "abs",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_factorial(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [&p](number_t& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = fabs(rhs);
-            p.push(result);
+            rhs = p.factorial_(rhs, &p.budget_);
          }
-      },
-      {
-         "acos",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_increment(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = acos(rhs);
-            p.push(result);
+            ++rhs;
          }
-      },
-      {
-         "asin",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_decrement(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = asin(rhs);
-            p.push(result);
+            --rhs;
          }
-      },
-      {
-         "atan",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_abs(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = atan(rhs);
-            p.push(result);
+            if constexpr (is_integer)
+            {
+               rhs = abs(rhs);
+            }
+            else
+            {
+               rhs = fabs(rhs);
+            }
          }
-      },
-      {
-         "atan2",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_acos(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            ensure(p.can_bop());
-            num_t rhs = p.pop();
-            num_t lhs = p.pop();
-            num_t result = atan2(lhs, rhs);
-            p.push(result);
+            rhs = acos(rhs);
          }
-      },
-      {
-        "mil",
-        [](postfix_t& p)
-        {
-          if (!p.can_bop())
-          {
-            ooo(eee) << "push distance yds";
-            ooo(eee) << "push speed mph";
-            ooo(eee) << "returns mils/s";
-            return;
-          }
-          num_t speed_mph = p.pop();
-          num_t distance_yds = p.pop();
-          num_t speed_yps = speed_mph * 1760 / 3600;
-          num_t mrads_per_s = 1000*atan(speed_yps / distance_yds);
-          p.push(mrads_per_s);
-        }
-      },
-      {
-        "mph",
-        [](postfix_t& p)
-        {
-          if (!p.can_bop())
-          {
-            ooo(eee) << "push distance yds";
-            ooo(eee) << "push speed mils/s";
-            ooo(eee) << "returns mph";
-            return;
-          }
-          num_t mrads_per_second = p.pop();
-          num_t distance_yds = p.pop();
-          num_t rads_per_second = mrads_per_second / 1000.0;
-
-          // rads_per_second is typically quite small so
-          // tan(theta) ~= theta. We could probably omit
-          // this call to tan but leaving it in for
-          // completeness. For hasty mover calculations, you
-          // could easily omit it and get a good solution.
-          // https://en.wikipedia.org/wiki/Small-angle_approximation
-          num_t displacement_per_second  = tan(rads_per_second);
-          num_t speed_yps = distance_yds * displacement_per_second;
-          num_t speed_mph = speed_yps * 3600.0 / 1760.0;
-          p.push(speed_mph);
-        }
-      },
-      {
-        // lorentz factor, gamma
-        "gam",
-        [](postfix_t& p)
-        {
-          if (!p.can_uop())
-          {
-            ooo(eee) << "lorentz factor - (1 - (v^2/c^2))^-0.5";
-            return;
-          }
-          p.push(2);
-          p.push("^"); // v^2
+      );
+   }
+
+   static void op_asin(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
+         {
+            rhs = asin(rhs);
+         }
+      );
+   }
 
-          p.push("c");
-          p.push(2);
-          p.push("^"); // c^2
+   static void op_atan(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
+         {
+            rhs = atan(rhs);
+         }
+      );
+   }
 
-          p.push("/");
+   static void op_atan2(basic_postfix_t& p)
+   {
+      p.apply_real_binary
+      (
+         [](auto& lhs, const auto& rhs)
+         {
+            lhs = atan2(lhs, rhs);
+         }
+      );
+   }
 
-          p.push(-1);
-          p.push("*"); // -beta
+   static void op_mil(basic_postfix_t& p)
+   {
+     if constexpr (is_integer)
+     {
+       throw "not an integer operator";
+     }
+     else
+     {
+       if (!p.can_bop())
+       {
+         ooo(eee) << "push distance yds";
+         ooo(eee) << "push speed mph";
+         ooo(eee) << "returns mils/s";
+         return;
+       }
+       number_t speed_mph = p.pop();
+       number_t distance_yds = p.pop();
+       number_t speed_yps = speed_mph * 1760 / 3600;
+       number_t mrads_per_s = 1000*atan(speed_yps / distance_yds);
+       p.push(mrads_per_s);
+     }
+   }
 
-          p.push(1);
-          p.push("+"); // 1 - beta
+   static void op_mph(basic_postfix_t& p)
+   {
+     if constexpr (is_integer)
+     {
+       throw "not an integer operator";
+     }
+     else
+     {
+       if (!p.can_bop())
+       {
+         ooo(eee) << "push distance yds";
+         ooo(eee) << "push speed mils/s";
+         ooo(eee) << "returns mph";
+         return;
+       }
+       number_t mrads_per_second = p.pop();
+       number_t distance_yds = p.pop();
+       number_t rads_per_second = mrads_per_second / 1000.0;
 
-          p.push("sqrt");
+       // rads_per_second is typically quite small so
+       // tan(theta) ~= theta. We could probably omit
+       // this call to tan but leaving it in for
+       // completeness. For hasty mover calculations, you
+       // could easily omit it and get a good solution.
+       // https://en.wikipedia.org/wiki/Small-angle_approximation
+       number_t displacement_per_second  = tan(rads_per_second);
+       number_t speed_yps = distance_yds * displacement_per_second;
+       number_t speed_mph = speed_yps * 3600.0 / 1760.0;
+       p.push(speed_mph);
+     }
+   }
 
-          p.push(-1);
-          p.push("^");
-        }
-      },
+   // lorentz factor, gamma
+   static void op_gam(basic_postfix_t& p)
+   {
+      if constexpr (is_integer)
       {
-        "lor",
-        [](postfix_t& p)
-        {
-          p.push("gam");
-        }
-      },
+         throw "not an integer operator";
+      }
+      else
       {
-         "avg",
-         [](postfix_t& p)
+         if (!p.can_uop())
          {
-            num_t result = 0;
-            num_t count = 0;
-            while (p.can_uop())
+            ooo(eee) << "lorentz factor - (1 - (v^2/c^2))^-0.5";
+            return;
+         }
+         // Each step is the one its operator would take, so
+         // the result is v 2 ^ c 2 ^ / -1 * 1 + sqrt -1 ^ to
+         // the last digit.
+         p.apply_unary
+         (
+            [](number_t& v)
             {
-               ++count;
-               result += p.pop();
+               static const number_t c2 = pow(number_t(299792458), number_t(2));
+               v = pow(v, number_t(2));
+               v /= c2;
+               v *= number_t(-1); // -beta
+               v += number_t(1); // 1 - beta
+               v = sqrt(v);
+               v = pow(v, number_t(-1));
             }
-            result /= count;
-            p.push(result);
-         }
-      },
-      {
-         "bin",
-         [](postfix_t& p)
+         );
+      }
+   }
+
+   static void op_lor(basic_postfix_t& p)
+   {
+      op_gam(p);
+   }
+
+   static void op_avg(basic_postfix_t& p)
+   {
+      p.reduce
+      (
+         [&p](const value_stack_t<number_t>& numbers)
          {
-            p.display_type(display_types_t::bin);
+            number_t result = p.total(numbers);
+            result /= p.depth();
+            return result;
          }
-      },
-      {
-         "c",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_bin(basic_postfix_t& p)
+   {
+      p.display_type(display_types_t::bin);
+   }
+
+   static void op_c(basic_postfix_t& p)
+   {
+     p.push(299792458);
+   }
+
+   static void op_ceil(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-           p.push(299792458);
+            if constexpr (!is_integer)
+            {
+               rhs = ceil(rhs);
+            }
          }
-      },
-      {
-         "ceil",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_cf(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = ceil(rhs);
-            p.push(result);
+            rhs = (rhs * 9 / 5) + 32;
          }
-      },
+      );
+   }
+
+   static void op_past(basic_postfix_t& p)
+   {
+      if constexpr (is_integer)
+      {
+         throw "not an integer operator";
+      }
+      else
       {
-         "cf",
-         [](postfix_t& p)
+         // equation derived from curve fit of data, done in
+         // the steps of -0.231 * e swap ^ 1.23e15 * 60 *
+         p.apply_unary
+         (
+            [](number_t& t)
+            {
+               if (t < 126)
+               {
+                  // Never, which rat has no way to say.
+                  if constexpr (!std::numeric_limits<number_t>::has_infinity)
+                  {
+                     throw "not a finite number";
+                  }
+                  t = parse("inf");
+                  return;
+               }
+               static const number_t rate = parse("-0.231");
+               static const number_t scale = parse("1.23e15");
+               t *= rate;
+               t = pow(constants_t<number_t>::e(), t);
+               t *= scale;
+               t *= number_t(60.0);
+            }
+         );
+      }
+   }
+
+   static void op_clear(basic_postfix_t& p)
+   {
+      p.clear();
+   }
+
+   static void op_clr(basic_postfix_t& p)
+   {
+      op_clear(p);
+   }
+
+   static void op_cos(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-           ensure(p.can_uop());
-           num_t rhs = p.pop();
-           num_t result = (rhs * 9 / 5) + 32;
-           p.push(result);
+            rhs = cos(rhs);
          }
-      },
-      {
-        "past",
-        [](postfix_t& p)
-        {
-          if (p.top() < 126)
-          {
-            p.pop();
-            p.push("inf");
-            return;
-          }
-          // equation derived from curve fit of data
-          ensure(p.can_uop());
-          p.push("-0.231");
-          p.push("*");
-          p.push("e");
-          p.push("swap");
-          p.push("^");
-          p.push("1.23e15");
-          p.push("*");
-          p.push(60.0);
-          p.push("*");
-        }
-      },
-      {
-         "clear",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_cosh(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            p.clear();
+            rhs = cosh(rhs);
          }
-      },
+      );
+   }
+
+   static void op_dec(basic_postfix_t& p)
+   {
+      p.display_type(display_types_t::dec);
+   }
+
+   static void op_com(basic_postfix_t& p)
+   {
+      p.display_type(display_types_t::com);
+   }
+
+   /**
+    * Show only as many significant digits as the top of the
+    * stack says, or all of them for 0.
+    */
+   static void op_digits(basic_postfix_t& p)
+   {
+      ensure(p.can_uop());
+      const number_t rhs = p.top();
+      ensure(rhs >= 0 && whole(rhs) && rhs <= max_display_digits);
+      p.display_digits(static_cast<std::size_t>(rhs));
+      p.pop();
+   }
+
+   /**
+    * Group com mode's integer digits by as many as the top of
+    * the stack says, keeping the separator, or not at all for
+    * 0.
+    */
+   static void op_group(basic_postfix_t& p)
+   {
+      ensure(p.can_uop());
+      const number_t rhs = p.top();
+      ensure(rhs >= 0 && whole(rhs) && rhs <= max_group);
+      p.grouping(commaifier_t(static_cast<std::size_t>(rhs), p.grouping().separator()));
+      p.pop();
+   }
+
+   static void op_e(basic_postfix_t& p)
+   {
+      if constexpr (is_integer)
+      {
+         throw "not an integer operator";
+      }
+      else
       {
-         "clr",
-         [](postfix_t& p)
+         p.push(constants_t<number_t>::e());
+      }
+   }
+
+   static void op_exp(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            p.push("clear");
+            rhs = exp(rhs);
          }
-      },
-      {
-         "cos",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_eng(basic_postfix_t& p)
+   {
+      p.display_type(display_types_t::eng);
+   }
+
+   static void op_fc(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = cos(rhs);
-            p.push(result);
+            rhs = (rhs - 32) * 5 / 9;
          }
-      },
-      {
-         "cosh",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_floor(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = cosh(rhs);
-            p.push(result);
+            if constexpr (!is_integer)
+            {
+               rhs = floor(rhs);
+            }
          }
-      },
-      {
-         "dec",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_fj(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            p.display_type(display_types_t::dec);
+            rhs = rhs * joules_in_one_foot_pound<number_t>;
          }
-      },
-      {
-         "com",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_frac(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-            p.display_type(display_types_t::com);
+            if constexpr (is_integer)
+            {
+               rhs = 0;
+            }
+            else
+            {
+               rhs = rhs - trunc(rhs);
+            }
          }
-      },
+      );
+   }
+
+   static void op_frexp(basic_postfix_t& p)
+   {
+      if constexpr (is_integer)
       {
-         "e",
-         [](postfix_t& p)
+         throw "not an integer operator";
+      }
+      else
+      {
+         ensure(p.can_uop());
+         int exp = 0;
+         number_t rhs = p.pop();
+         number_t result = frexp(rhs, &exp);
+         p.push(result);
+         p.push(exp);
+      }
+   }
+
+   static void op_fm(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            p.push(exp(num_t(1)));
+            rhs = rhs / feet_in_one_meter<number_t>;
          }
-      },
-      {
-         "exp",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_gl(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = exp(rhs);
-            p.push(result);
+            rhs = rhs * liters_in_one_gallon<number_t>;
          }
-      },
-      {
-         "eng",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_hex(basic_postfix_t& p)
+   {
+      p.display_type(display_types_t::hex);
+   }
+
+   static void op_hw(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            p.display_type(display_types_t::eng);
+            rhs = rhs * watts_in_one_horsepower<number_t>;
          }
-      },
-      {
-         "fc",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_jf(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-           ensure(p.can_uop());
-           num_t rhs = p.pop();
-           num_t result = (rhs - 32) * 5 / 9;
-           p.push(result);
+            rhs = rhs / joules_in_one_foot_pound<number_t>;
          }
-      },
-      {
-         "floor",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_kp(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = floor(rhs);
-            p.push(result);
+            rhs = rhs / pounds_in_one_kilogram<number_t>;
          }
-      },
-      {
-         "fj",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_lg(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = rhs * joules_in_one_foot_pound;
-            p.push(result);
+            rhs /= liters_in_one_gallon<number_t>;
          }
-      },
-      {
-         "frac",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_log(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = rhs - trunc(rhs);
-            p.push(result);
+            rhs = log10(rhs);
          }
-      },
+      );
+   }
+
+   static void op_l2(basic_postfix_t& p)
+   {
+      op_log2(p);
+   }
+
+   static void op_log2(basic_postfix_t& p)
+   {
+      if constexpr (is_integer)
       {
-         "frexp",
-         [](postfix_t& p)
-         {
-            ensure(p.can_uop());
-            int exp = 0;
-            num_t rhs = p.pop();
-            num_t result = frexp(rhs, &exp);
-            p.push(result);
-            p.push(exp);
-         }
-      },
+         throw "not an integer operator";
+      }
+      else
       {
-         "fm",
-         [](postfix_t& p)
+         // As x log 2 log /, to the last digit.
+         p.apply_unary
+         (
+            [](number_t& rhs)
+            {
+               static const number_t log2 = log10(number_t(2));
+               rhs = log10(rhs);
+               rhs /= log2;
+            }
+         );
+      }
+   }
+
+   static void op_ln(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = rhs / feet_in_one_meter;
-            p.push(result);
+            rhs = log(rhs);
          }
-      },
-      {
-         "gl",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_mf(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = rhs * liters_in_one_gallon;
-            p.push(result);
+            rhs = rhs * feet_in_one_meter<number_t>;
          }
-      },
-      {
-         "hex",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_neg(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-            p.display_type(display_types_t::hex);
+            rhs = -rhs;
          }
-      },
-      {
-         "hw",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_oct(basic_postfix_t& p)
+   {
+      p.display_type(display_types_t::oct);
+   }
+
+   static void op_pk(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = rhs * watts_in_one_horsepower;
-            p.push(result);
+            rhs = rhs * pounds_in_one_kilogram<number_t>;
          }
-      },
+      );
+   }
+
+   static void op_pi(basic_postfix_t& p)
+   {
+      if constexpr (is_integer)
       {
-         "jf",
-         [](postfix_t& p)
-         {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = rhs / joules_in_one_foot_pound;
-            p.push(result);
-         }
-      },
+         throw "not an integer operator";
+      }
+      else
       {
-         "kp",
-         [](postfix_t& p)
+         p.push(constants_t<number_t>::pi());
+      }
+   }
+
+   static void op_pop(basic_postfix_t& p)
+   {
+      ensure(p.can_uop());
+      p.pop();
+   }
+
+   static void op_p(basic_postfix_t& p)
+   {
+      op_pop(p);
+   }
+
+   static void op_prod(basic_postfix_t& p)
+   {
+      p.reduce
+      (
+         [&p](const value_stack_t<number_t>& numbers)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = rhs / pounds_in_one_kilogram;
-            p.push(result);
+            auto multiply = [](number_t& lhs, const number_t& rhs)
+            {
+               lhs *= rhs;
+            };
+            tree_t<number_t> tree(p.budget_, p.threads_);
+            number_t result = 1;
+            if (numbers.size() != 0)
+            {
+               result = tree(numbers.begin(), numbers.end(), multiply);
+            }
+            if (!p.sequence_.empty())
+            {
+               result *= tree(p.sequence_.begin(), p.sequence_.end(), multiply);
+            }
+            return result;
          }
-      },
-      {
-         "lg",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_round(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.top();
-            num_t result = rhs / liters_in_one_gallon;
-            p.push(result);
+            if constexpr (!is_integer)
+            {
+               rhs = round(rhs);
+            }
          }
-      },
+      );
+   }
+
+   // The sequence operators leave their values pending; see
+   // sequence_.
+
+   static void op_seq0(basic_postfix_t& p)
+   {
+      ensure(p.can_uop());
+      const number_t rhs = p.top();
+      sequence_t<number_t> sequence = sequence_t<number_t>::between(0, 1, rhs);
+      if (!sequence.empty() && sequence.back() == rhs)
       {
-         "log",
-         [](postfix_t& p)
-         {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = log10(rhs);
-            p.push(result);
-         }
-      },
+         sequence.pop_back();
+      }
+      p.replace_with_sequence(1, sequence);
+   }
+
+   static void op_seq1(basic_postfix_t& p)
+   {
+      ensure(p.can_uop());
+      p.replace_with_sequence(1, sequence_t<number_t>::between(1, 1, p.top()));
+   }
+
+   static void op_seq2(basic_postfix_t& p)
+   {
+      ensure(p.can_bop());
+      number_t lhs = p.numbers_.top();
+      number_t rhs = p.numbers_.top(1);
+      if (lhs > rhs)
       {
-        "l2",
-        [](postfix_t& p)
-        {
-          p.push("log2");
-        }
-      },
+         std::swap(lhs, rhs);
+      }
+      p.replace_with_sequence(2, sequence_t<number_t>::between(lhs, 1, rhs));
+   }
+
+   static void op_seq3(basic_postfix_t& p)
+   {
+      ensure(p.can_top());
+      number_t lhs = p.numbers_.top();
+      number_t incr = p.numbers_.top(1);
+      number_t rhs = p.numbers_.top(2);
+      if (lhs > rhs)
       {
-         "log2",
-         [](postfix_t& p)
+         std::swap(lhs, rhs);
+      }
+      ensure(incr > 0);
+      p.replace_with_sequence(3, sequence_t<number_t>::between(lhs, incr, rhs));
+   }
+
+   static void op_sin(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = log10(rhs);
-            p.push(result);
-            p.push(2);
-            p.push("log");
-            p.push("/");
+            rhs = sin(rhs);
          }
-      },
-      {
-         "ln",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_sinh(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = log(rhs);
-            p.push(result);
+            rhs = sinh(rhs);
          }
-      },
-      {
-         "mf",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_sqrt(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = rhs * feet_in_one_meter;
-            p.push(result);
+            // An integer's is rounded down.
+            if constexpr (is_integer)
+            {
+               if (rhs < 0)
+               {
+                  throw "square root of a negative integer";
+               }
+            }
+            rhs = sqrt(rhs);
          }
-      },
+      );
+   }
+
+   /**
+    * @return the statistics of the stack in one pass, read
+    * where the values lie and, for a pending sequence, as
+    * they are made.
+    */
+   stats_t<number_t> collect_stats()
+   {
+      stats_t<number_t> result;
+      for (const number_t& n : numbers_)
       {
-         "neg",
-         [](postfix_t& p)
-         {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = -rhs;
-            p.push(result);
-         }
-      },
+         budget_.charge();
+         result.add(n);
+      }
+      for (const number_t n : sequence_)
       {
-         "oct",
-         [](postfix_t& p)
-         {
-            p.display_type(display_types_t::oct);
-         }
-      },
+         budget_.charge();
+         result.add(n);
+      }
+      return result;
+   }
+
+   /**
+    * The sample standard deviation of the stack.
+    */
+   static void op_stddev(basic_postfix_t& p)
+   {
+      if constexpr (is_integer)
       {
-         "pk",
-         [](postfix_t& p)
+         throw "not an integer operator";
+      }
+      p.reduce
+      (
+         [&p](const value_stack_t<number_t>&)
          {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = rhs * pounds_in_one_kilogram;
-            p.push(result);
+            return p.collect_stats().stddev();
          }
-      },
+      );
+   }
+
+   /**
+    * Replace the stack with its count, sum, mean, sample
+    * variance, sample standard deviation, minimum and
+    * maximum, the maximum on top.
+    */
+   static void op_stats(basic_postfix_t& p)
+   {
+      if constexpr (is_integer)
       {
-         "pi",
-         [](postfix_t& p)
+         throw "not an integer operator";
+      }
+      ensure(p.can_uop());
+      const stats_t<number_t> stats = p.collect_stats();
+      p.clear();
+      p.push(stats.count());
+      p.push(stats.sum());
+      p.push(stats.mean());
+      p.push(stats.variance());
+      p.push(stats.stddev());
+      p.push(stats.min());
+      p.push(stats.max());
+   }
+
+   static void op_sum(basic_postfix_t& p)
+   {
+      p.reduce
+      (
+         [&p](const value_stack_t<number_t>& numbers)
          {
-            p.push(boost::math::constants::pi<num_t>());
+            return p.total(numbers);
          }
-      },
-      {
-         "pop",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_swap(basic_postfix_t& p)
+   {
+      ensure(p.can_bop());
+      using std::swap;
+      swap(p.numbers_.top(), p.numbers_.top(1));
+   }
+
+   static void op_sw(basic_postfix_t& p)
+   {
+      op_swap(p);
+   }
+
+   static void op_tan(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            ensure(p.can_uop());
-            p.pop();
+            rhs = tan(rhs);
          }
-      },
-      {
-        "p",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_tanh(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            p.push("pop");
+            rhs = tanh(rhs);
          }
-      },
-      {
-         "prod",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_trunc(basic_postfix_t& p)
+   {
+      p.apply_unary
+      (
+         [](number_t& rhs)
          {
-            num_t result = 1;
-            while (p.can_uop())
-            {
-               result *= p.pop();
-            }
-            p.push(result);
-         }
-      },
-      {
-         "round",
-         [](postfix_t& p)
-         {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = round(rhs);
-            p.push(result);
-         }
-      },
-      {
-        "seq0",
-        [](postfix_t& p)
-        {
-          ensure(p.can_uop());
-          num_t rhs = p.pop();
-          for (num_t i = 0; i < rhs; ++i)
-          {
-            p.push(i);
-          }
-        }
-      },
-      {
-        "seq1",
-        [](postfix_t& p)
-        {
-          ensure(p.can_uop());
-          num_t rhs = p.pop();
-          for (num_t i = 1; i <= rhs; ++i)
-          {
-            p.push(i);
-          }
-        }
-      },
-      {
-        "seq2",
-        [](postfix_t& p)
-        {
-          ensure(p.can_bop());
-          num_t lhs = p.pop();
-          num_t rhs = p.pop();
-          if (lhs > rhs)
-          {
-            num_t tmp = lhs;
-            lhs = rhs;
-            rhs = tmp;
-          }
-          for (num_t i = lhs; i <= rhs; ++i)
-          {
-            p.push(i);
-          }
-        }
-      },
-      {
-        "seq3",
-        [](postfix_t& p)
-        {
-          ensure(p.can_top());
-          num_t lhs = p.pop();
-          num_t incr = p.pop();
-          num_t rhs = p.pop();
-          if (lhs > rhs)
-          {
-            num_t tmp = lhs;
-            lhs = rhs;
-            rhs = tmp;
-          }
-          for (num_t i = lhs; i <= rhs; i += incr)
-          {
-            p.push(i);
-          }
-        }
-      },
-      {
-         "sin",
-         [](postfix_t& p)
-         {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = sin(rhs);
-            p.push(result);
-         }
-      },
-      {
-         "sinh",
-         [](postfix_t& p)
-         {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = sinh(rhs);
-            p.push(result);
-         }
-      },
-      {
-         "sqrt",
-         [](postfix_t& p)
-         {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = sqrt(rhs);
-            p.push(result);
-         }
-      },
-      {
-         "stddev",
-         [](postfix_t& p)
-         {
-            num_t sum = 0;
-            num_t count = 0;
-            std::vector<num_t> copies;
-            while (p.can_uop())
-            {
-               num_t x = p.pop();
-               sum += x;
-               ++count;
-               copies.push_back(x);
-            }
-            num_t avg = sum / count;
-            num_t sum_of_square_diffs = 0;
-            for (auto n : copies)
+            if constexpr (!is_integer)
             {
-               num_t diff = n - avg;
-               diff *= diff;
-               sum_of_square_diffs += diff;
+               rhs = trunc(rhs);
             }
-            num_t result = sum_of_square_diffs / (count - 1);
-            p.push(result);
          }
-      },
-      {
-         "sum",
-         [](postfix_t& p)
+      );
+   }
+
+   static void op_wh(basic_postfix_t& p)
+   {
+      p.apply_real
+      (
+         [](auto& rhs)
          {
-            num_t result = 0;
-            while (p.can_uop())
-            {
-               result += p.pop();
-            }
-            p.push(result);
-         }
-      },
-      {
-         "swap",
-         [](postfix_t& p)
-         {
-            ensure(p.can_bop());
-            num_t rhs = p.pop();
-            num_t lhs = p.pop();
-            p.push(rhs);
-            p.push(lhs);
-         }
-      },
-      {
-        "sw",
-        [](postfix_t& p)
-        {
-          p.push("swap");
-        }
-      },
-      {
-         "tan",
-         [](postfix_t& p)
-         {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = tan(rhs);
-            p.push(result);
-         }
-      },
-      {
-         "tanh",
-         [](postfix_t& p)
-         {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = tanh(rhs);
-            p.push(result);
-         }
-      },
-      {
-         "trunc",
-         [](postfix_t& p)
-         {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = trunc(rhs);
-            p.push(result);
-         }
-      },
-      {
-         "wh",
-         [](postfix_t& p)
-         {
-            ensure(p.can_uop());
-            num_t rhs = p.pop();
-            num_t result = rhs / watts_in_one_horsepower;
-            p.push(result);
-         }
-      },
-      {
-        "pr",
-        [](postfix_t& p)
-        {
-          // =29.9212524*pow(1-pow(10, -5)*2.25577*(B2/3.280839895), 5.25588)
-          // from https://www.engineeringtoolbox.com/air-altitude-pressure-d_462.html
-          ensure(p.can_uop());
-          num_t rhs = p.pop(); // expects feet of elevation
-          num_t meters = rhs / 3.280839895;
-          num_t inner_term = meters * 2.25577 * pow(10, -5);
-          inner_term = 1 - inner_term;
-          num_t outer_term = pow(inner_term, 5.25588);
-          num_t result = outer_term * 29.9212524;
-          p.push(result);
-        }
-      },
-   };
+            rhs = rhs / watts_in_one_horsepower<number_t>;
+         }
+      );
+   }
+
+   static void op_pr(basic_postfix_t& p)
+   {
+     // =29.9212524*pow(1-pow(10, -5)*2.25577*(B2/3.280839895), 5.25588)
+     // from https://www.engineeringtoolbox.com/air-altitude-pressure-d_462.html
+     p.apply_real
+     (
+       [](auto& rhs) // expects feet of elevation
+       {
+         using real_t = std::decay_t<decltype(rhs)>;
+         real_t meters = rhs / 3.280839895;
+         real_t inner_term = meters * 2.25577 * pow(10, -5);
+         inner_term = 1 - inner_term;
+         real_t outer_term = pow(inner_term, 5.25588);
+         rhs = outer_term * 29.9212524;
+       }
+     );
+   }
 };
 
+using postfix_t = basic_postfix_t<num_t>;
+
 /**
  * Ostream support for postfix_t.
  */
-inline std::ostream& operator<<(std::ostream& o, const postfix_t& p)
+template <typename number_t>
+std::ostream& operator<<(std::ostream& o, const basic_postfix_t<number_t>& p)
 {
-   static hex_printer_t hex_printer;
-   static oct_printer_t oct_printer;
-   static bin_printer_t bin_printer;
-   stream_saver_t saver(o);
-
-   const std::size_t count = p.numbers_.size();
+   const std::size_t count = p.depth();
    std::size_t i = 0;
-   for (num_t num : p.numbers_)
+   auto write = [&o, &p, &i, count](const number_t& num)
    {
-      switch (p.display_type())
+      if (p.display_type() == display_types_t::com)
       {
-         case display_types_t::hex:
-            o << hex_printer.convert(num);
-            break;
-         case display_types_t::oct:
-            o << oct_printer.convert(num);
-            break;
-         case display_types_t::bin:
-            o << bin_printer.convert(num);
-            break;
-         case display_types_t::eng:
-            o << num;
-            break;
-         case display_types_t::com:
-            o << commaifier_t(num.str()).str();
-            break;
-         case display_types_t::dec:
-         default:
-            o << num.str();
-            break;
+         p.grouping().write(o, num_traits_t<number_t>::str(num, p.display_digits()));
+      }
+      else
+      {
+         o << basic_postfix_t<number_t>::format
+         (
+            num,
+            p.display_type(),
+            p.grouping(),
+            p.display_digits()
+         );
       }
       if (i < count - 1) o << "   ";
       ++i;
+   };
+   for (const number_t& num : p.numbers_)
+   {
+      write(num);
+   }
+   for (const number_t num : p.sequence_)
+   {
+      write(num);
    }
 
    return o;
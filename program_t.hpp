@@ -0,0 +1,227 @@
+#ifndef __program_t_hpp__
+#define __program_t_hpp__
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include "budget_t.hpp"
+#include "debug.hpp"
+#include "num_t.hpp"
+#include "op_t.hpp"
+#include "postfix_t.hpp"
+
+/**
+ * A compiled expression. Every token is resolved once when
+ * it is pushed into the program: operators become op_t
+ * codes dispatched by a switch and number literals are
+ * parsed into constants. Running the program does no string
+ * handling at all.
+ */
+template <typename number_t>
+struct basic_program_t
+{
+   using postfix_type = basic_postfix_t<number_t>;
+
+   basic_program_t()
+      :slots_(0)
+   {
+   }
+
+   /**
+    * @param[in] inputs the names of the values handed to
+    * run() and evaluate(), in the order they will be given.
+    * Input names are case insensitive and take precedence
+    * over operators of the same name.
+    */
+   explicit basic_program_t(const std::vector<std::string>& inputs)
+      :inputs_(inputs)
+      ,slots_(0)
+   {
+      for (std::string& input : inputs_)
+      {
+         boost::algorithm::to_lower(input);
+      }
+   }
+
+   /**
+    * Append one postfix token to the program.
+    * @param[in] token an input name, an operator name or a
+    * number literal
+    */
+   void push(const std::string& token)
+   {
+      if (!inputs_.empty())
+      {
+         std::string lowered = boost::algorithm::to_lower_copy(token);
+         auto input = std::find(inputs_.begin(), inputs_.end(), lowered);
+         if (input != inputs_.end())
+         {
+            emit(opcode_t::input, input - inputs_.begin());
+            return;
+         }
+      }
+
+      op_t op;
+      if (find_op(token, op))
+      {
+         emit(opcode_t::call, static_cast<std::size_t>(op));
+         return;
+      }
+
+      push(postfix_type::parse(token));
+   }
+
+   /**
+    * Append a constant to the program.
+    */
+   void push(const number_t& constant)
+   {
+      emit(opcode_t::constant, constants_.size());
+      constants_.push_back(constant);
+   }
+
+   /**
+    * Execute the program on top of whatever is already on
+    * p's stack. The whole run shares one of p's budgets.
+    * @param[in] inputs the values of the named inputs
+    */
+   void run
+   (
+      postfix_type& p,
+      const std::vector<number_t>& inputs = std::vector<number_t>()
+   ) const
+   {
+      std::vector<number_t> slots;
+      run(p, inputs, slots);
+   }
+
+   /**
+    * run() for a caller that runs the program many times.
+    * @param[in,out] slots room for the values an optimized
+    * program keeps between its steps. It is grown as needed
+    * and can be passed to the next run as it is, which saves
+    * making the numbers again each time.
+    */
+   void run
+   (
+      postfix_type& p,
+      const std::vector<number_t>& inputs,
+      std::vector<number_t>& slots
+   ) const
+   {
+      ensure(inputs.size() == inputs_.size());
+      budget_t::scope_t scope(p.budget());
+      if (slots.size() < slots_)
+      {
+         slots.resize(slots_);
+      }
+      for (const instruction_t& i : code_)
+      {
+         switch (i.opcode)
+         {
+            case opcode_t::constant:
+               p.push(constants_[i.operand]);
+               break;
+            case opcode_t::input:
+               p.push(inputs[i.operand]);
+               break;
+            case opcode_t::call:
+               p.execute(static_cast<op_t>(i.operand));
+               break;
+            case opcode_t::store:
+               slots[i.operand] = p.top();
+               break;
+            case opcode_t::load:
+               p.push(slots[i.operand]);
+               break;
+            case opcode_t::square:
+               p.apply_unary
+               (
+                  [](number_t& x)
+                  {
+                     // The same multiplication * would do.
+                     const number_t rhs = x;
+                     x *= rhs;
+                  }
+               );
+               break;
+         }
+      }
+   }
+
+   /**
+    * Execute the program against a fresh stack.
+    * @return the top of the stack when the program ends
+    */
+   number_t evaluate
+   (
+      const std::vector<number_t>& inputs = std::vector<number_t>()
+   ) const
+   {
+      postfix_type p;
+      run(p, inputs);
+      return p.top();
+   }
+
+   /**
+    * @return the number of instructions in the program.
+    */
+   std::size_t size() const
+   {
+      return code_.size();
+   }
+
+   bool empty() const
+   {
+      return code_.empty();
+   }
+
+   /**
+    * @return the names of the inputs the program expects.
+    */
+   const std::vector<std::string>& inputs() const
+   {
+      return inputs_;
+   }
+
+private:
+   template <typename other_t>
+   friend struct basic_optimizer_t;
+
+   // Only the optimizer emits the last three.
+   enum class opcode_t : std::uint8_t
+   {
+      constant,
+      input,
+      call,
+      // Copy the top of the stack to a slot, leaving it.
+      store,
+      // Push a copy of a slot.
+      load,
+      // x x * without pushing x twice.
+      square,
+   };
+
+   struct instruction_t
+   {
+      opcode_t opcode;
+      std::uint32_t operand;
+   };
+
+   void emit(opcode_t opcode, std::size_t operand)
+   {
+      code_.push_back({opcode, static_cast<std::uint32_t>(operand)});
+   }
+
+   std::vector<std::string> inputs_;
+   std::vector<instruction_t> code_;
+   std::vector<number_t> constants_;
+   // How many values store and load need to keep per run.
+   std::size_t slots_;
+};
+
+using program_t = basic_program_t<num_t>;
+
+#endif
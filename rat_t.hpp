@@ -0,0 +1,752 @@
+#ifndef __rat_t_hpp__
+#define __rat_t_hpp__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <ios>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <boost/math/special_functions/fpclassify.hpp>
+#include <boost/math/special_functions/gamma.hpp>
+#include "num_t.hpp"
+#include "num_traits_t.hpp"
+
+struct rat_t;
+
+namespace boost
+{
+   namespace multiprecision
+   {
+      template <>
+      struct number_category<rat_t>
+         :std::integral_constant<int, number_kind_rational>
+      {
+      };
+   }
+}
+
+// Boost's operators consult numeric_limits while rat_t is
+// still being defined, so the specialization comes first.
+namespace std
+{
+   template <>
+   class numeric_limits<rat_t>
+   {
+   public:
+      static constexpr bool is_specialized = true;
+      static constexpr bool is_signed = true;
+      static constexpr bool is_integer = false;
+      static constexpr bool is_exact = true;
+      static constexpr bool has_infinity = false;
+      static constexpr bool has_quiet_NaN = false;
+      static constexpr bool has_signaling_NaN = false;
+      // Scaling by powers of two is exact, as in a binary
+      // float. digits is how far radix modes print a
+      // fraction that doesn't terminate: as far as num_t
+      // would.
+      static constexpr int radix = 2;
+      static constexpr int digits10 = numeric_limits<num_t>::digits10;
+      static constexpr int digits = digits10 * 33220L / 10000 + 1;
+      static constexpr int max_digits10 = numeric_limits<num_t>::max_digits10;
+      static constexpr int min_exponent = 0;
+      static constexpr int min_exponent10 = 0;
+      static constexpr int max_exponent = 0;
+      static constexpr int max_exponent10 = 0;
+      static constexpr bool has_denorm_loss = false;
+      static constexpr float_denorm_style has_denorm = denorm_absent;
+      static constexpr bool is_iec559 = false;
+      static constexpr bool is_bounded = false;
+      static constexpr bool is_modulo = false;
+      static constexpr bool traps = false;
+      static constexpr bool tinyness_before = false;
+      static constexpr float_round_style round_style = round_toward_zero;
+      static rat_t min();
+      static rat_t max();
+      static rat_t lowest();
+      static rat_t round_error();
+      static rat_t denorm_min();
+      static rat_t signaling_NaN();
+      static rat_t infinity();
+      static rat_t quiet_NaN();
+      static rat_t epsilon();
+   };
+}
+
+/**
+ * An exact rational number, numerator / denominator over
+ * int_t, for the rat backend.
+ *
+ * + - * / and the rounding functions are exact. The
+ * denominator stays positive but is only reduced by the gcd
+ * once it grows past reduce_bits, or when the value is
+ * printed, so a chain of sums over a common denominator
+ * costs no gcd at all. Transcendental functions go through
+ * num_t and bring back the exact value of its result; there
+ * is no infinity or nan, so a result that would be one, and
+ * division by zero, throw instead.
+ */
+struct rat_t
+{
+   static constexpr std::size_t reduce_bits = 512;
+
+   // The most bits an integer power or a shift may give the
+   // numerator or the denominator, the int backend's limit.
+   static constexpr std::size_t max_power_bits = std::size_t(1) << 24;
+
+   rat_t()
+      :numerator_(0)
+      ,denominator_(1)
+   {
+   }
+
+   template
+   <
+      typename integer_t,
+      typename std::enable_if<std::is_integral<integer_t>::value, int>::type = 0
+   >
+   rat_t(integer_t i)
+      :numerator_(i)
+      ,denominator_(1)
+   {
+   }
+
+   rat_t(const int_t& i)
+      :numerator_(i)
+      ,denominator_(1)
+   {
+   }
+
+   /**
+    * @throw "division by zero" when denominator is 0
+    */
+   rat_t(int_t numerator, int_t denominator)
+      :numerator_(std::move(numerator))
+      ,denominator_(std::move(denominator))
+   {
+      if (denominator_ == 0)
+      {
+         throw "division by zero";
+      }
+      if (denominator_ < 0)
+      {
+         numerator_ = -numerator_;
+         denominator_ = -denominator_;
+      }
+      settle();
+   }
+
+   /**
+    * The exact value of d, which is a binary fraction.
+    */
+   rat_t(double d)
+      :rat_t(num_t(d))
+   {
+   }
+
+   /**
+    * The exact value of a finite decimal.
+    * @throw "not a finite number" for inf and nan
+    */
+   explicit rat_t(const num_t& n)
+      :rat_t()
+   {
+      if (!boost::math::isfinite(n))
+      {
+         throw "not a finite number";
+      }
+      *this = rat_t(n.str(0, std::ios_base::scientific));
+   }
+
+   /**
+    * Read a decimal, optionally with a point and an
+    * exponent, or a ratio such as 22/7.
+    * @throw std::runtime_error when s is neither
+    */
+   explicit rat_t(const std::string& s)
+      :rat_t()
+   {
+      const std::size_t slash = s.find('/');
+      if (slash != std::string::npos)
+      {
+         *this = rat_t(integer(s.substr(0, slash)), integer(s.substr(slash + 1)));
+         return;
+      }
+
+      const std::size_t e = s.find_first_of("eE");
+      std::string digits = s.substr(0, e);
+      long exponent = 0;
+      if (e != std::string::npos)
+      {
+         const std::string text = s.substr(e + 1);
+         const std::size_t sign = !text.empty() && (text[0] == '-' || text[0] == '+');
+         if
+         (
+            text.size() == sign
+            || text.size() - sign > 6
+            || text.find_first_not_of("0123456789", sign) != std::string::npos
+         )
+         {
+            throw std::runtime_error("invalid exponent");
+         }
+         exponent = std::stol(text);
+      }
+      const std::size_t point = digits.find('.');
+      if (point != std::string::npos)
+      {
+         exponent -= static_cast<long>(digits.size() - point - 1);
+         digits.erase(point, 1);
+      }
+      numerator_ = integer(digits);
+      const int_t scale = boost::multiprecision::pow(int_t(10), static_cast<unsigned>(std::abs(exponent)));
+      if (exponent >= 0)
+      {
+         numerator_ *= scale;
+      }
+      else
+      {
+         denominator_ = scale;
+      }
+      settle();
+   }
+
+   explicit rat_t(const char* s)
+      :rat_t(std::string(s))
+   {
+   }
+
+   const int_t& numerator() const
+   {
+      reduce();
+      return numerator_;
+   }
+
+   const int_t& denominator() const
+   {
+      reduce();
+      return denominator_;
+   }
+
+   /**
+    * @return the nearest num_t.
+    */
+   num_t decimal() const
+   {
+      if (denominator_ == 1)
+      {
+         return num_traits_t<num_t>::from_int(numerator_);
+      }
+      return num_traits_t<num_t>::from_int(numerator_)
+         / num_traits_t<num_t>::from_int(denominator_);
+   }
+
+   /**
+    * Integers are written exactly, anything else as the
+    * nearest num_t would be.
+    */
+   std::string str
+   (
+      std::streamsize digits = 0,
+      std::ios_base::fmtflags flags = std::ios_base::fmtflags(0)
+   ) const
+   {
+      reduce();
+      if (denominator_ == 1 && digits == 0)
+      {
+         return numerator_.str();
+      }
+      return decimal().str(digits, flags);
+   }
+
+   /**
+    * @return the integer part.
+    */
+   explicit operator int_t() const
+   {
+      if (denominator_ == 1)
+      {
+         return numerator_;
+      }
+      return numerator_ / denominator_;
+   }
+
+   template
+   <
+      typename integer_t,
+      typename std::enable_if<std::is_integral<integer_t>::value, int>::type = 0
+   >
+   explicit operator integer_t() const
+   {
+      return static_cast<integer_t>(static_cast<int_t>(*this));
+   }
+
+   explicit operator double() const
+   {
+      return static_cast<double>(decimal());
+   }
+
+   rat_t& operator+=(const rat_t& rhs)
+   {
+      if (denominator_ == rhs.denominator_)
+      {
+         numerator_ += rhs.numerator_;
+      }
+      else
+      {
+         numerator_ = numerator_ * rhs.denominator_ + rhs.numerator_ * denominator_;
+         denominator_ *= rhs.denominator_;
+      }
+      settle();
+      return *this;
+   }
+
+   rat_t& operator-=(const rat_t& rhs)
+   {
+      if (denominator_ == rhs.denominator_)
+      {
+         numerator_ -= rhs.numerator_;
+      }
+      else
+      {
+         numerator_ = numerator_ * rhs.denominator_ - rhs.numerator_ * denominator_;
+         denominator_ *= rhs.denominator_;
+      }
+      settle();
+      return *this;
+   }
+
+   rat_t& operator*=(const rat_t& rhs)
+   {
+      numerator_ *= rhs.numerator_;
+      denominator_ *= rhs.denominator_;
+      settle();
+      return *this;
+   }
+
+   /**
+    * @throw "division by zero"
+    */
+   rat_t& operator/=(const rat_t& rhs)
+   {
+      if (rhs.numerator_ == 0)
+      {
+         throw "division by zero";
+      }
+      int_t numerator = numerator_ * rhs.denominator_;
+      int_t denominator = denominator_ * rhs.numerator_;
+      if (denominator < 0)
+      {
+         numerator = -numerator;
+         denominator = -denominator;
+      }
+      numerator_ = std::move(numerator);
+      denominator_ = std::move(denominator);
+      settle();
+      return *this;
+   }
+
+   rat_t& operator++()
+   {
+      numerator_ += denominator_;
+      return *this;
+   }
+
+   rat_t& operator--()
+   {
+      numerator_ -= denominator_;
+      return *this;
+   }
+
+   rat_t operator-() const
+   {
+      rat_t result = *this;
+      result.numerator_ = -result.numerator_;
+      return result;
+   }
+
+   rat_t operator+() const
+   {
+      return *this;
+   }
+
+   friend rat_t operator+(rat_t lhs, const rat_t& rhs)
+   {
+      lhs += rhs;
+      return lhs;
+   }
+
+   friend rat_t operator-(rat_t lhs, const rat_t& rhs)
+   {
+      lhs -= rhs;
+      return lhs;
+   }
+
+   friend rat_t operator*(rat_t lhs, const rat_t& rhs)
+   {
+      lhs *= rhs;
+      return lhs;
+   }
+
+   friend rat_t operator/(rat_t lhs, const rat_t& rhs)
+   {
+      lhs /= rhs;
+      return lhs;
+   }
+
+   friend bool operator==(const rat_t& lhs, const rat_t& rhs)
+   {
+      return compare(lhs, rhs) == 0;
+   }
+
+   friend bool operator!=(const rat_t& lhs, const rat_t& rhs)
+   {
+      return compare(lhs, rhs) != 0;
+   }
+
+   friend bool operator<(const rat_t& lhs, const rat_t& rhs)
+   {
+      return compare(lhs, rhs) < 0;
+   }
+
+   friend bool operator<=(const rat_t& lhs, const rat_t& rhs)
+   {
+      return compare(lhs, rhs) <= 0;
+   }
+
+   friend bool operator>(const rat_t& lhs, const rat_t& rhs)
+   {
+      return compare(lhs, rhs) > 0;
+   }
+
+   friend bool operator>=(const rat_t& lhs, const rat_t& rhs)
+   {
+      return compare(lhs, rhs) >= 0;
+   }
+
+   friend std::ostream& operator<<(std::ostream& o, const rat_t& r)
+   {
+      r.reduce();
+      if (r.denominator_ == 1)
+      {
+         return o << r.numerator_;
+      }
+      return o << r.decimal();
+   }
+
+private:
+   static int compare(const rat_t& lhs, const rat_t& rhs)
+   {
+      if (lhs.denominator_ == rhs.denominator_)
+      {
+         return lhs.numerator_.compare(rhs.numerator_);
+      }
+      return (lhs.numerator_ * rhs.denominator_).compare(rhs.numerator_ * lhs.denominator_);
+   }
+
+   /**
+    * @throw std::runtime_error unless s is an optionally
+    * signed run of decimal digits
+    */
+   static int_t integer(const std::string& s)
+   {
+      const std::size_t sign = !s.empty() && (s[0] == '-' || s[0] == '+');
+      if (s.size() == sign || s.find_first_not_of("0123456789", sign) != std::string::npos)
+      {
+         throw std::runtime_error("invalid rational");
+      }
+      // int_t would read a leading 0 as octal.
+      const std::size_t first = std::min(s.find_first_not_of('0', sign), s.size() - 1);
+      const int_t magnitude(s.c_str() + first);
+      return s[0] == '-' ? int_t(-magnitude) : magnitude;
+   }
+
+   /**
+    * Reduce once the denominator has grown enough for the
+    * gcd to pay for itself.
+    */
+   void settle()
+   {
+      if (denominator_ != 1 && msb(denominator_) >= reduce_bits)
+      {
+         reduce();
+      }
+   }
+
+   void reduce() const
+   {
+      if (denominator_ == 1)
+      {
+         return;
+      }
+      const int_t divisor = gcd(numerator_, denominator_);
+      if (divisor != 1)
+      {
+         numerator_ /= divisor;
+         denominator_ /= divisor;
+      }
+   }
+
+   // Reducing doesn't change the value.
+   mutable int_t numerator_;
+   mutable int_t denominator_;
+};
+
+// There is no infinity, nan, bound or smallest step.
+#define MANCALC_RAT_LIMIT(name) \
+   inline rat_t std::numeric_limits<rat_t>::name() \
+   { \
+      return rat_t(); \
+   }
+
+MANCALC_RAT_LIMIT(min)
+MANCALC_RAT_LIMIT(max)
+MANCALC_RAT_LIMIT(lowest)
+MANCALC_RAT_LIMIT(epsilon)
+MANCALC_RAT_LIMIT(round_error)
+MANCALC_RAT_LIMIT(infinity)
+MANCALC_RAT_LIMIT(quiet_NaN)
+MANCALC_RAT_LIMIT(signaling_NaN)
+MANCALC_RAT_LIMIT(denorm_min)
+
+#undef MANCALC_RAT_LIMIT
+
+/**
+ * Exact functions of a rat_t.
+ */
+inline rat_t trunc(const rat_t& r)
+{
+   return rat_t(static_cast<int_t>(r));
+}
+
+inline rat_t floor(const rat_t& r)
+{
+   rat_t result = trunc(r);
+   if (result > r)
+   {
+      --result;
+   }
+   return result;
+}
+
+inline rat_t ceil(const rat_t& r)
+{
+   rat_t result = trunc(r);
+   if (result < r)
+   {
+      ++result;
+   }
+   return result;
+}
+
+/**
+ * @return r rounded to the nearest integer, halves away
+ * from zero.
+ */
+inline rat_t round(const rat_t& r)
+{
+   const rat_t half(int_t(1), int_t(2));
+   return r < 0 ? -floor(half - r) : floor(r + half);
+}
+
+inline rat_t fabs(const rat_t& r)
+{
+   return r < 0 ? -r : r;
+}
+
+inline rat_t abs(const rat_t& r)
+{
+   return fabs(r);
+}
+
+/**
+ * @return lhs - trunc(lhs / rhs) * rhs, like fmod.
+ */
+inline rat_t fmod(const rat_t& lhs, const rat_t& rhs)
+{
+   return lhs - trunc(lhs / rhs) * rhs;
+}
+
+/**
+ * @throw "rational too large" when the numerator or the
+ * denominator would need more than rat_t::max_power_bits,
+ * the same limit as pow, since this is a power of two.
+ */
+inline rat_t ldexp(const rat_t& r, int exponent)
+{
+   if (r == 0)
+   {
+      return r;
+   }
+   const int_t& grows = exponent >= 0 ? r.numerator() : r.denominator();
+   if (int_t(msb(abs(grows))) + 1 + abs(int_t(exponent)) > rat_t::max_power_bits)
+   {
+      throw "rational too large";
+   }
+   if (exponent >= 0)
+   {
+      return r * rat_t(int_t(1) << exponent);
+   }
+   return r / rat_t(int_t(1) << -exponent);
+}
+
+/**
+ * @return r as f * 2^*exponent with 0.5 <= |f| < 1.
+ */
+inline rat_t frexp(const rat_t& r, int* exponent)
+{
+   if (r == 0)
+   {
+      *exponent = 0;
+      return r;
+   }
+   const rat_t magnitude = fabs(r);
+   int e =
+      static_cast<int>(msb(magnitude.numerator()))
+      - static_cast<int>(msb(magnitude.denominator())) + 1;
+   // Scaled by hand rather than with ldexp, so that a value
+   // already past ldexp's limit can still be taken apart.
+   int_t numerator = magnitude.numerator();
+   int_t denominator = magnitude.denominator();
+   if (e > 0)
+   {
+      denominator <<= e;
+   }
+   else
+   {
+      numerator <<= -e;
+   }
+   rat_t f(numerator, denominator);
+   if (f >= 1)
+   {
+      f = rat_t(f.numerator(), f.denominator() * 2);
+      ++e;
+   }
+   else if (f < rat_t(int_t(1), int_t(2)))
+   {
+      f = rat_t(f.numerator() * 2, f.denominator());
+      --e;
+   }
+   *exponent = e;
+   return r < 0 ? -f : f;
+}
+
+/**
+ * Exact for a perfect square, the nearest num_t's value
+ * otherwise.
+ */
+inline rat_t sqrt(const rat_t& r)
+{
+   if (r >= 0)
+   {
+      int_t numerator_rest;
+      int_t denominator_rest;
+      int_t numerator = sqrt(r.numerator(), numerator_rest);
+      int_t denominator = sqrt(r.denominator(), denominator_rest);
+      if (numerator_rest == 0 && denominator_rest == 0)
+      {
+         return rat_t(numerator, denominator);
+      }
+   }
+   return rat_t(sqrt(r.decimal()));
+}
+
+/**
+ * Exact for an integer exponent, the nearest num_t's value
+ * otherwise.
+ * @throw "rational too large" when the numerator or the
+ * denominator would need more than rat_t::max_power_bits
+ */
+inline rat_t pow(const rat_t& base, const rat_t& exponent)
+{
+   if
+   (
+      exponent.denominator() == 1
+      && fabs(exponent) <= std::numeric_limits<unsigned>::max()
+   )
+   {
+      const unsigned e = static_cast<unsigned>(static_cast<int_t>(fabs(exponent)));
+      // Checked before any work, as the int backend does,
+      // since nothing can interrupt the power itself.
+      for (const int_t* part : {&base.numerator(), &base.denominator()})
+      {
+         if (abs(*part) > 1 && (int_t(msb(abs(*part))) + 1) * e > rat_t::max_power_bits)
+         {
+            throw "rational too large";
+         }
+      }
+      rat_t result
+      (
+         boost::multiprecision::pow(base.numerator(), e),
+         boost::multiprecision::pow(base.denominator(), e)
+      );
+      return exponent < 0 ? 1 / result : result;
+   }
+   return rat_t(pow(base.decimal(), exponent.decimal()));
+}
+
+// Everything else is computed in num_t.
+#define MANCALC_RAT_UNARY(name) \
+   inline rat_t name(const rat_t& r) \
+   { \
+      return rat_t(name(r.decimal())); \
+   }
+
+MANCALC_RAT_UNARY(sin)
+MANCALC_RAT_UNARY(cos)
+MANCALC_RAT_UNARY(tan)
+MANCALC_RAT_UNARY(asin)
+MANCALC_RAT_UNARY(acos)
+MANCALC_RAT_UNARY(atan)
+MANCALC_RAT_UNARY(sinh)
+MANCALC_RAT_UNARY(cosh)
+MANCALC_RAT_UNARY(tanh)
+MANCALC_RAT_UNARY(exp)
+MANCALC_RAT_UNARY(log)
+MANCALC_RAT_UNARY(log10)
+MANCALC_RAT_UNARY(log2)
+
+#undef MANCALC_RAT_UNARY
+
+inline rat_t atan2(const rat_t& y, const rat_t& x)
+{
+   return rat_t(atan2(y.decimal(), x.decimal()));
+}
+
+/**
+ * @throw "not a finite number" where tgamma overflows
+ */
+inline rat_t tgamma(const rat_t& r)
+{
+   try
+   {
+      return rat_t(boost::math::tgamma(r.decimal()));
+   }
+   catch (const std::overflow_error&)
+   {
+      throw "not a finite number";
+   }
+}
+
+namespace boost
+{
+   namespace math
+   {
+      template <>
+      inline bool isnan<rat_t>(rat_t)
+      {
+         return false;
+      }
+
+      template <>
+      inline bool isfinite<rat_t>(rat_t)
+      {
+         return true;
+      }
+   }
+}
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef __sequence_t_hpp__
+#define __sequence_t_hpp__
+
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include "num_t.hpp"
+#include "num_traits_t.hpp"
+
+/**
+ * The arithmetic sequence first, first + step, ... of size
+ * values, kept as those three numbers rather than as the
+ * values themselves. Value i is first + i * step, computed
+ * when it is asked for, so it is exact whenever first and
+ * step are and carries a single rounding otherwise.
+ */
+template <typename number_t>
+struct sequence_t
+{
+   // Room to count past the end without overflowing.
+   static constexpr std::size_t max_size = std::numeric_limits<std::size_t>::max() / 4;
+
+   /**
+    * Walks the values in order. It is random access so that
+    * tree_t can split it, and a value is made each time it
+    * is dereferenced.
+    */
+   struct iterator
+   {
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = number_t;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = number_t;
+
+      iterator(const sequence_t& sequence, std::size_t index)
+         :sequence_(&sequence)
+         ,index_(index)
+      {
+      }
+
+      number_t operator*() const
+      {
+         return (*sequence_)[index_];
+      }
+
+      iterator& operator++()
+      {
+         ++index_;
+         return *this;
+      }
+
+      iterator& operator--()
+      {
+         --index_;
+         return *this;
+      }
+
+      iterator& operator+=(difference_type n)
+      {
+         index_ += n;
+         return *this;
+      }
+
+      iterator& operator-=(difference_type n)
+      {
+         index_ -= n;
+         return *this;
+      }
+
+      difference_type operator-(const iterator& rhs) const
+      {
+         return static_cast<difference_type>(index_ - rhs.index_);
+      }
+
+      bool operator==(const iterator& rhs) const
+      {
+         return index_ == rhs.index_;
+      }
+
+      bool operator!=(const iterator& rhs) const
+      {
+         return index_ != rhs.index_;
+      }
+
+   private:
+      const sequence_t* sequence_;
+      std::size_t index_;
+   };
+
+   sequence_t()
+      :first_(0)
+      ,step_(1)
+      ,size_(0)
+      ,unit_(true)
+   {
+   }
+
+   sequence_t(const number_t& first, const number_t& step, std::size_t size)
+      :first_(first)
+      ,step_(step)
+      ,size_(size)
+      ,unit_(step == 1)
+   {
+   }
+
+   /**
+    * @param[in] step must be positive
+    * @return the values from first up to and including last,
+    * none when last is below first.
+    * @throw "sequence too long" when there would be more than
+    * max_size of them
+    */
+   static sequence_t between
+   (
+      const number_t& first,
+      const number_t& step,
+      const number_t& last
+   )
+   {
+      sequence_t result(first, step, 0);
+      // Written so that nan gives no values.
+      if (!(first <= last))
+      {
+         return result;
+      }
+      number_t span = last;
+      span -= first;
+      if (!result.unit_)
+      {
+         span /= step;
+      }
+      if (!(span < max_size))
+      {
+         throw "sequence too long";
+      }
+      result.size_ = static_cast<std::size_t>(num_traits_t<number_t>::to_int(span)) + 1;
+
+      // The division may have rounded either way; the values
+      // themselves have the last word.
+      while (result.size_ > 0 && result[result.size_ - 1] > last)
+      {
+         --result.size_;
+      }
+      while (result[result.size_] <= last)
+      {
+         ++result.size_;
+      }
+      return result;
+   }
+
+   number_t operator[](std::size_t i) const
+   {
+      number_t result(i);
+      if (!unit_)
+      {
+         result *= step_;
+      }
+      result += first_;
+      return result;
+   }
+
+   number_t back() const
+   {
+      return (*this)[size_ - 1];
+   }
+
+   void pop_back()
+   {
+      --size_;
+   }
+
+   std::size_t size() const
+   {
+      return size_;
+   }
+
+   bool empty() const
+   {
+      return size_ == 0;
+   }
+
+   iterator begin() const
+   {
+      return iterator(*this, 0);
+   }
+
+   iterator end() const
+   {
+      return iterator(*this, size_);
+   }
+
+   /**
+    * @return the sum of the values, size * first plus the
+    * triangular number size * (size - 1) / 2 times step.
+    */
+   number_t sum() const
+   {
+      if (size_ == 0)
+      {
+         return number_t(0);
+      }
+      // Halve whichever factor is even so that the triangular
+      // number is exact.
+      const bool even = size_ % 2 == 0;
+      number_t triangle(even ? size_ / 2 : size_);
+      triangle *= number_t(even ? size_ - 1 : (size_ - 1) / 2);
+      if (!unit_)
+      {
+         triangle *= step_;
+      }
+      number_t result(size_);
+      result *= first_;
+      result += triangle;
+      return result;
+   }
+
+private:
+   number_t first_;
+   number_t step_;
+   std::size_t size_;
+   // Whether step is 1, when a value costs an addition and no
+   // multiplication.
+   bool unit_;
+};
+
+#endif
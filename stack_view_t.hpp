@@ -0,0 +1,169 @@
+#ifndef __stack_view_t_hpp__
+#define __stack_view_t_hpp__
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "commaifier_t.hpp"
+#include "display_types_t.hpp"
+#include "num_t.hpp"
+#include "postfix_t.hpp"
+
+/**
+ * Renders the top of an engine's stack for the interactive
+ * prompt. Only the top window entries are shown, preceded by
+ * the depth of the stack when some are hidden. Each entry's
+ * text is kept per display mode and rendered again only when
+ * the entry changes, so a prompt after a small change to a
+ * deep stack costs a few entries rather than all of them.
+ * Texts are only kept for the window and as many entries
+ * again below it, so a sequence that is still pending is
+ * shown without its values being pushed.
+ */
+template <typename number_t>
+struct basic_stack_view_t
+{
+   using postfix_type = basic_postfix_t<number_t>;
+
+   /**
+    * @param[in] window how many entries to show, 0 for all
+    */
+   explicit basic_stack_view_t(std::size_t window = 8)
+      :window_(window)
+      ,rendered_(0)
+      ,digits_(0)
+   {
+   }
+
+   /**
+    * Write the visible part of p's stack to o.
+    */
+   void render(std::ostream& o, postfix_type& p)
+   {
+      const std::size_t size = p.depth();
+      const std::size_t unchanged = p.unchanged();
+      p.mark_unchanged();
+
+      for (texts_t& texts : cache_)
+      {
+         texts.keep(unchanged);
+      }
+      const display_types_t mode = p.display_type();
+      if (p.grouping() != grouping_)
+      {
+         grouping_ = p.grouping();
+         cache_[display_types_t::com].keep(0);
+      }
+      if (p.display_digits() != digits_)
+      {
+         digits_ = p.display_digits();
+         cache_[display_types_t::dec].keep(0);
+         cache_[display_types_t::eng].keep(0);
+         cache_[display_types_t::com].keep(0);
+      }
+
+      std::size_t first = 0;
+      if (window_ != 0 && size > window_)
+      {
+         first = size - window_;
+         o << "(" << size << ") ...   ";
+      }
+      texts_t& texts = cache_[mode];
+      texts.cover(first, first > window_ ? first - window_ : 0, size);
+
+      rendered_ = 0;
+      for (std::size_t i = first; i < size; ++i)
+      {
+         std::string& text = texts[i];
+         if (text.empty())
+         {
+            text = postfix_type::format
+            (
+               p.at(i),
+               mode,
+               grouping_,
+               digits_
+            );
+            ++rendered_;
+         }
+         o << text;
+         if (i < size - 1) o << "   ";
+      }
+   }
+
+   std::size_t window() const
+   {
+      return window_;
+   }
+
+   void window(std::size_t window)
+   {
+      window_ = window;
+   }
+
+   /**
+    * @return how many entries the last render had to format.
+    */
+   std::size_t rendered() const
+   {
+      return rendered_;
+   }
+
+private:
+   /**
+    * One display mode's texts for the entries from index
+    * first up; an empty text is one still to be rendered.
+    */
+   struct texts_t
+   {
+      /**
+       * Forget the texts of entries at index count and above.
+       */
+      void keep(std::size_t count)
+      {
+         texts_.resize(count > first_ ? std::min(count - first_, texts_.size()) : 0);
+      }
+
+      /**
+       * Make room for the entries from first up to size and
+       * forget any below lowest.
+       */
+      void cover(std::size_t first, std::size_t lowest, std::size_t size)
+      {
+         if (first < first_)
+         {
+            texts_.insert(texts_.begin(), first_ - first, std::string());
+            first_ = first;
+         }
+         else if (lowest > first_)
+         {
+            const std::size_t forget = std::min(lowest - first_, texts_.size());
+            texts_.erase(texts_.begin(), texts_.begin() + forget);
+            first_ = lowest;
+         }
+         texts_.resize(size - first_);
+      }
+
+      std::string& operator[](std::size_t index)
+      {
+         return texts_[index - first_];
+      }
+
+   private:
+      std::size_t first_ = 0;
+      std::vector<std::string> texts_;
+   };
+
+   std::size_t window_;
+   std::size_t rendered_;
+   commaifier_t grouping_;
+   std::size_t digits_;
+   std::array<texts_t, display_types_t::com + 1> cache_;
+};
+
+using stack_view_t = basic_stack_view_t<num_t>;
+
+#endif
@@ -0,0 +1,188 @@
+#ifndef __stats_t_hpp__
+#define __stats_t_hpp__
+
+#include <cstddef>
+#include "num_t.hpp"
+#include "num_traits_t.hpp"
+
+/**
+ * Count, sum, mean, variance, minimum and maximum of a run of
+ * values in one pass.
+ *
+ * While every value is an integer whose square fits in 64
+ * bits, the sums of the values and of their squares are kept
+ * exactly in int_t, which costs a conversion and two integer
+ * additions per value rather than a full precision multiply,
+ * and leaves a single rounding in the variance. The first
+ * other value hands the running totals over to Welford's
+ * update of the mean and of the sum of squared differences
+ * from it, which unlike summing x and x^2 in number_t doesn't
+ * lose the variance to cancellation when the values are
+ * large and close together.
+ */
+template <typename number_t>
+struct stats_t
+{
+   stats_t()
+      :count_(0)
+      ,exact_(true)
+      ,sum_(0)
+      ,mean_(0)
+      ,m2_(0)
+      ,min_(0)
+      ,max_(0)
+   {
+   }
+
+   void add(const number_t& x)
+   {
+      if (count_ == 0 || x < min_)
+      {
+         min_ = x;
+      }
+      if (count_ == 0 || x > max_)
+      {
+         max_ = x;
+      }
+      ++count_;
+
+      if (exact_)
+      {
+         // Comparing first keeps the conversion in range;
+         // nan fails both.
+         if (x > -small && x < small)
+         {
+            const long long i = static_cast<long long>(x);
+            if (number_t(i) == x)
+            {
+               integer_sum_ += i;
+               integer_squares_ += i * i;
+               return;
+            }
+         }
+         leave_exact(count_ - 1);
+      }
+
+      sum_ += x;
+      delta_ = x;
+      delta_ -= mean_;
+      step_ = delta_;
+      step_ /= count_;
+      mean_ += step_;
+      step_ = x;
+      step_ -= mean_;
+      step_ *= delta_;
+      m2_ += step_;
+   }
+
+   std::size_t count() const
+   {
+      return count_;
+   }
+
+   number_t sum() const
+   {
+      if (exact_)
+      {
+         return num_traits_t<number_t>::from_int(integer_sum_);
+      }
+      return sum_;
+   }
+
+   number_t mean() const
+   {
+      if (count_ == 0)
+      {
+         return number_t(0);
+      }
+      if (exact_)
+      {
+         return number_t(sum() / count_);
+      }
+      return mean_;
+   }
+
+   /**
+    * @return the sample variance, 0 for fewer than two
+    * values.
+    */
+   number_t variance() const
+   {
+      if (count_ < 2)
+      {
+         return number_t(0);
+      }
+      if (exact_)
+      {
+         return number_t
+         (
+            num_traits_t<number_t>::from_int(spread(count_))
+            / num_traits_t<number_t>::from_int(int_t(count_) * (count_ - 1))
+         );
+      }
+      return number_t(m2_ / (count_ - 1));
+   }
+
+   /**
+    * @return the sample standard deviation.
+    */
+   number_t stddev() const
+   {
+      return number_t(sqrt(variance()));
+   }
+
+   const number_t& min() const
+   {
+      return min_;
+   }
+
+   const number_t& max() const
+   {
+      return max_;
+   }
+
+private:
+   // Integers below this in magnitude have squares that fit
+   // in a long long.
+   static constexpr long long small = 1LL << 31;
+
+   /**
+    * @return count * sum(x^2) - sum(x)^2 over the first count
+    * values, which is count times the sum of their squared
+    * differences from their mean.
+    */
+   int_t spread(std::size_t count) const
+   {
+      return int_t(count) * integer_squares_ - integer_sum_ * integer_sum_;
+   }
+
+   /**
+    * Carry the exact totals of the first count values over
+    * to Welford's.
+    */
+   void leave_exact(std::size_t count)
+   {
+      exact_ = false;
+      if (count == 0)
+      {
+         return;
+      }
+      sum_ = num_traits_t<number_t>::from_int(integer_sum_);
+      mean_ = sum_ / count;
+      m2_ = num_traits_t<number_t>::from_int(spread(count)) / count;
+   }
+
+   std::size_t count_;
+   bool exact_;
+   int_t integer_sum_;
+   int_t integer_squares_;
+   number_t sum_;
+   number_t mean_;
+   number_t m2_;
+   number_t min_;
+   number_t max_;
+   number_t delta_;
+   number_t step_;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include ".test.hpp"
+#include "compiler_t.hpp"
+#include "batch_t.hpp"
+
+TEST(whitespace_records)
+{
+   compiler_t compiler;
+   program_t program = compiler.infix("x * y + 1", {"x", "y"});
+   batch_t batch(program, false);
+   std::stringstream in("1 2\n  3\t4 \n\n10 10\n");
+   std::stringstream out;
+   std::stringstream err;
+   EQ(0, batch.run(in, out, err));
+   EQ("3\n13\n\n101\n", out.str());
+   EQ("", err.str());
+}
+
+TEST(csv_records)
+{
+   compiler_t compiler;
+   program_t program = compiler.postfix("a b -", {"a", "b"});
+   batch_t batch(program, true);
+   std::stringstream in("5, 3\n0x10,1\n");
+   std::stringstream out;
+   std::stringstream err;
+   EQ(0, batch.run(in, out, err));
+   EQ("2\n15\n", out.str());
+}
+
+TEST(bad_records_keep_rows_aligned)
+{
+   compiler_t compiler;
+   program_t program = compiler.infix("x + 1", {"x"});
+   batch_t batch(program, false);
+   std::stringstream in("1\nbogus\n1 2\n3\n");
+   std::stringstream out;
+   std::stringstream err;
+   EQ(2, batch.run(in, out, err));
+   EQ("2\n\n\n4\n", out.str());
+   NE(std::string::npos, err.str().find("row 2"));
+   NE(std::string::npos, err.str().find("row 3"));
+}
+
+TEST(inputs_shadow_operators)
+{
+   compiler_t compiler;
+   program_t program = compiler.infix("C * 2", {"c"});
+   EQ(6, program.evaluate({3}));
+   THROW(program.evaluate(), const char*);
+}
+
+TEST(records_over_budget_fail)
+{
+   compiler_t compiler;
+   program_t program = compiler.postfix("n seq1 sum", {"n"});
+   batch_t batch(program, false);
+   batch.budget().step_limit(1000);
+   std::stringstream in("10\n100000\n100\n");
+   std::stringstream out;
+   std::stringstream err;
+   EQ(1, batch.run(in, out, err));
+   EQ("55\n\n5050\n", out.str());
+   EQ("row 2: cancelled\n", err.str());
+}
+
+TEST(blank_rows_keep_rows_aligned)
+{
+   compiler_t compiler;
+   program_t program = compiler.infix("x * x", {"x"});
+   batch_t batch(program, false);
+   std::stringstream in("4\n\n  \n9\n");
+   std::stringstream out;
+   std::stringstream err;
+   EQ(0, batch.run(in, out, err));
+   EQ("16\n\n\n81\n", out.str());
+   EQ("", err.str());
+}
+
+TEST(oversized_records_fail)
+{
+   compiler_t compiler;
+   program_t program = compiler.postfix("x seq1 neg", {"x"});
+   batch_t batch(program, false);
+   std::stringstream in("1e12\n3\n");
+   std::stringstream out;
+   std::stringstream err;
+   EQ(1, batch.run(in, out, err));
+   EQ("\n-3\n", out.str());
+   EQ("row 1: sequence too long\n", err.str());
+}
+
+TEST(constant_programs_ignore_fields)
+{
+   compiler_t compiler;
+   batch_t batch(compiler.infix("6 * 7", {}), false);
+   std::stringstream in("1\n\nanything, at all\n");
+   std::stringstream out;
+   std::stringstream err;
+   EQ(0, batch.run(in, out, err));
+   EQ("42\n\n42\n", out.str());
+   EQ("", err.str());
+}
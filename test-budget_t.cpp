@@ -0,0 +1,162 @@
+#include <thread>
+#include ".test.hpp"
+#include "budget_t.hpp"
+#include "postfix_t.hpp"
+
+TEST(unlimited)
+{
+   budget_t b;
+   budget_t::scope_t scope(b);
+   for (int i = 0; i < 100000; ++i)
+   {
+      b.charge();
+   }
+   BOOST_REQUIRE(!b.cancelled());
+}
+
+TEST(step_limit)
+{
+   budget_t b;
+   b.step_limit(10);
+   {
+      budget_t::scope_t scope(b);
+      BOOST_REQUIRE(b.busy());
+      b.charge(10);
+      THROW(b.charge(), const char*);
+      BOOST_REQUIRE(b.cancelled());
+   }
+   BOOST_REQUIRE(!b.busy());
+   budget_t::scope_t scope(b);
+   BOOST_REQUIRE(!b.cancelled());
+   b.charge(10);
+}
+
+TEST(nested_scopes_share)
+{
+   budget_t b;
+   b.step_limit(10);
+   budget_t::scope_t outer(b);
+   b.charge(6);
+   budget_t::scope_t inner(b);
+   THROW(b.charge(6), const char*);
+}
+
+TEST(time_limit)
+{
+   budget_t b;
+   b.time_limit(std::chrono::milliseconds(10));
+   budget_t::scope_t scope(b);
+   auto start = budget_t::clock_type::now();
+   THROW
+   (
+      while (true)
+      {
+         b.charge();
+      },
+      const char*
+   );
+   BOOST_REQUIRE(budget_t::clock_type::now() - start < std::chrono::seconds(5));
+}
+
+TEST(sequence_restores_operands)
+{
+   postfix_t p;
+   p.budget().step_limit(100);
+   p.push(7);
+   p.push(1000);
+   THROW(p.push("seq1"), const char*);
+   EQ("7   1000", p.str());
+   p.push(1);
+   p.push(2);
+   THROW(p.push("seq3"), const char*);
+   EQ("7   1000   1   2", p.str());
+   p.push("clear");
+   p.push(50);
+   p.push("seq1");
+   EQ(50, p.top());
+   p.push("sum");
+   EQ(1275, p.top());
+}
+
+TEST(reductions_restore_stack)
+{
+   postfix_t p;
+   p.budget().step_limit(3);
+   p.push(1);
+   p.push(2);
+   p.push(3);
+   p.push(4);
+   THROW(p.push("sum"), const char*);
+   THROW(p.push("prod"), const char*);
+   THROW(p.push("avg"), const char*);
+   THROW(p.push("stddev"), const char*);
+   EQ("1   2   3   4", p.str());
+}
+
+TEST(factorial_restores_operand)
+{
+   postfix_t p;
+   p.budget().step_limit(10);
+   p.push(5000);
+   THROW(p.push("!"), const char*);
+   EQ(5000, p.top());
+}
+
+TEST(watchdog)
+{
+   postfix_t p;
+   p.push(1e12);
+   p.push("seq1");
+   std::thread watchdog
+   (
+      [&p]()
+      {
+         while (!p.budget().busy())
+         {
+            std::this_thread::yield();
+         }
+         p.budget().cancel();
+      }
+   );
+   THROW(p.push("prod"), const char*);
+   watchdog.join();
+   BOOST_REQUIRE(p.budget().cancelled());
+   EQ(1e12, p.top());
+}
+
+TEST(checkpoint_restores_cancelled_line)
+{
+   postfix_t p;
+   p.push(7);
+   p.push(8);
+   budget_t::scope_t scope(p.budget());
+   const auto checkpoint = p.checkpoint();
+   p.budget().step_limit(100);
+   p.push(1);
+   p.push(2);
+   p.push("+");
+   p.push("+");
+   p.push(1000);
+   THROW(p.push("seq1"), const char*);
+   BOOST_REQUIRE(p.budget().cancelled());
+   BOOST_REQUIRE(p.restore(checkpoint));
+   EQ("7   8", p.str());
+}
+
+TEST(checkpoint_covers_only_marked_values)
+{
+   postfix_t p;
+   for (int i = 1; i <= 100; ++i)
+   {
+      p.push(i);
+   }
+   p.mark_unchanged();
+   const auto checkpoint = p.checkpoint();
+   p.push(1);
+   p.push("+");
+   BOOST_REQUIRE(p.restore(checkpoint));
+   EQ(100, p.depth());
+   EQ(100, p.top());
+   p.push("sum");
+   BOOST_REQUIRE(!p.restore(checkpoint));
+}
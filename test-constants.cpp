@@ -0,0 +1,50 @@
+#include <thread>
+#include <vector>
+#include ".test.hpp"
+#include "num_t.hpp"
+#include "constants.hpp"
+
+TEST(unit_factors_are_exact)
+{
+   const num_t foot("0.3048");
+   const num_t pound("0.45359237");
+   const num_t gravity("9.80665");
+   EQ(foot * gravity * pound, joules_in_one_foot_pound<num_t>);
+   EQ(550 * joules_in_one_foot_pound<num_t>, watts_in_one_horsepower<num_t>);
+   EQ(pound, pounds_in_one_kilogram<num_t>);
+   EQ(num_t("3.785411784"), liters_in_one_gallon<num_t>);
+   CL(num_t(1), feet_in_one_meter<num_t> * foot, num_t("1e-1000"));
+   EQ(num_t(1250) / 381, feet_in_one_meter<num_t>);
+}
+
+TEST(unit_factors_for_double)
+{
+   EQ(1.3558179483314004, joules_in_one_foot_pound<double>);
+   EQ(1250.0 / 381, feet_in_one_meter<double>);
+}
+
+TEST(full_precision)
+{
+   CL(exp(num_t(1)), constants_t<num_t>::e(), num_t("1e-1000"));
+   CL(exp(dec100_t(1)), constants_t<dec100_t>::e(), dec100_t("1e-90"));
+   CL(4 * atan(dec50_t(1)), constants_t<dec50_t>::pi(), dec50_t("1e-45"));
+}
+
+TEST(computed_once)
+{
+   const dec100_t* first = &constants_t<dec100_t>::pi();
+   std::vector<const dec100_t*> seen(8);
+   std::vector<std::thread> threads;
+   for (std::size_t i = 0; i < seen.size(); ++i)
+   {
+      threads.emplace_back([&seen, i] { seen[i] = &constants_t<dec100_t>::pi(); });
+   }
+   for (auto& t : threads)
+   {
+      t.join();
+   }
+   for (const dec100_t* p : seen)
+   {
+      BOOST_REQUIRE(p == first);
+   }
+}
@@ -0,0 +1,83 @@
+#include ".test.hpp"
+#include "num_t.hpp"
+#include "factorial_t.hpp"
+
+TEST(table)
+{
+   factorial_t<num_t> f;
+   EQ(1, f(0));
+   EQ(1, f(1));
+   EQ(3628800, f(10));
+   EQ(num_t("2432902008176640000"), f(20));
+}
+
+TEST(product_is_exact)
+{
+   factorial_t<num_t> f;
+   EQ(num_t("15511210043330985984000000"), f(25));
+   int_t expected = 1;
+   for (int i = 2; i <= 300; ++i)
+   {
+      expected *= i;
+   }
+   EQ(num_t(expected), f(300));
+}
+
+TEST(fractions_use_gamma)
+{
+   factorial_t<dec50_t> f;
+   dec50_t root_pi = sqrt(boost::math::constants::pi<dec50_t>());
+   CL(root_pi / 2, f(dec50_t("0.5")), 1e-40);
+   CL(root_pi, f(dec50_t("-0.5")), 1e-40);
+}
+
+TEST(poles_and_overflow)
+{
+   factorial_t<num_t> f;
+   BOOST_REQUIRE(boost::math::isnan(f(-1)));
+   BOOST_REQUIRE(boost::math::isnan(f(-20)));
+   BOOST_REQUIRE(boost::math::isinf(f(1e30)));
+}
+
+TEST(past_the_tree_limit)
+{
+   factorial_t<dec50_t> f;
+   dec50_t n = factorial_t<dec50_t>::tree_limit;
+   CL(f(n) * (n + 1), f(n + 1), 1e-40);
+}
+
+TEST(cache)
+{
+   factorial_t<num_t> f(2);
+   num_t first = f(500);
+   EQ(first, f(500));
+   f(501);
+   f(502);
+   f(503);
+   EQ(first, f(500));
+   factorial_t<num_t> uncached(0);
+   EQ(first, uncached(500));
+}
+
+TEST(double_backend)
+{
+   factorial_t<double> f;
+   EQ(3628800, f(10));
+   CL(7.257415615307994e306, f(170), 1e-10);
+   BOOST_REQUIRE(std::isinf(f(171)));
+   CL(0.886226925452758, f(0.5), 1e-10);
+}
+
+TEST(integers)
+{
+   factorial_t<int_t> f;
+   EQ(int_t(3628800), f(10));
+   int_t expected = 1;
+   for (int i = 2; i <= 300; ++i)
+   {
+      expected *= i;
+   }
+   EQ(expected, f(300));
+   THROW(f(-1), const char*);
+   THROW(f(factorial_t<int_t>::tree_limit + 1), const char*);
+}
@@ -0,0 +1,97 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include ".test.hpp"
+#include "pool_t.hpp"
+
+TEST(every_job_once)
+{
+   pool_t pool(3);
+   EQ(3, pool.workers());
+   std::vector<std::atomic<int>> calls(1000);
+   pool.run(calls.size(), 3, [&calls](std::size_t i) { ++calls[i]; });
+   for (const std::atomic<int>& count : calls)
+   {
+      EQ(1, count);
+   }
+}
+
+TEST(no_workers)
+{
+   pool_t pool(0);
+   std::size_t sum = 0;
+   pool.run(100, 8, [&sum](std::size_t i) { sum += i; });
+   EQ(4950, sum);
+}
+
+TEST(first_failure_rethrown)
+{
+   const auto fail_at_10 = [](std::atomic<int>& calls)
+   {
+      return [&calls](std::size_t i)
+      {
+         ++calls;
+         if (i == 10)
+         {
+            throw "job failed";
+         }
+      };
+   };
+
+   // Alone, the caller skips everything after the failure.
+   pool_t alone(0);
+   std::atomic<int> calls(0);
+   THROW(alone.run(1000, 0, fail_at_10(calls)), const char*);
+   EQ(11, calls);
+
+   pool_t pool(2);
+   calls = 0;
+   THROW(pool.run(1000, 2, fail_at_10(calls)), const char*);
+
+   // The pool is still usable.
+   calls = 0;
+   pool.run(10, 2, [&calls](std::size_t) { ++calls; });
+   EQ(10, calls);
+}
+
+TEST(shared_by_several_callers)
+{
+   pool_t pool(2);
+   std::vector<std::thread> callers;
+   std::vector<std::size_t> sums(4, 0);
+   for (std::size_t c = 0; c < sums.size(); ++c)
+   {
+      callers.emplace_back
+      (
+         [&pool, &sums, c]()
+         {
+            std::vector<std::size_t> values(64, 0);
+            pool.run
+            (
+               values.size(),
+               2,
+               [&pool, &values](std::size_t i)
+               {
+                  // A job may run a batch of its own.
+                  std::atomic<std::size_t> inner(0);
+                  pool.run(4, 2, [&inner, i](std::size_t j) { inner += i + j; });
+                  values[i] = inner;
+               }
+            );
+            for (std::size_t value : values)
+            {
+               sums[c] += value;
+            }
+         }
+      );
+   }
+   for (std::thread& caller : callers)
+   {
+      caller.join();
+   }
+   for (std::size_t sum : sums)
+   {
+      // 4 * (0 + ... + 63) + 64 * (0 + 1 + 2 + 3)
+      EQ(4 * 2016 + 64 * 6, sum);
+   }
+}
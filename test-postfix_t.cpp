@@ -1,3 +1,4 @@
+#include <sstream>
 #include ".test.hpp"
 #include "postfix_t.hpp"
 
@@ -87,6 +88,47 @@ TEST(basic_rshift)
    EQ(3086.25, p.top());
 }
 
+TEST(shift_exact_integer)
+{
+   postfix_t p;
+   p.push(3);
+   p.push(1000);
+   p.push("<<");
+   EQ(num_t(int_t(3) << 1000), p.top());
+   p.push(1000);
+   p.push(">>");
+   EQ(3, p.top());
+}
+
+TEST(shift_fraction)
+{
+   postfix_t p;
+   p.push(1);
+   p.push(1);
+   p.push(">>");
+   EQ(0.5, p.top());
+   p.push(0.5);
+   p.push("<<");
+   EQ(1, p.top());
+   p.push(-3);
+   p.push("<<");
+   EQ(1, p.top());
+}
+
+TEST(shift_huge_count)
+{
+   postfix_t p;
+   p.push(1);
+   p.push(100000);
+   p.push("<<");
+   p.push(100000);
+   p.push(">>");
+   CL(1, p.top(), 1e-100);
+   p.push(1e12);
+   p.push("<<");
+   EQ(true, isinf(p.top()));
+}
+
 TEST(basic_pow)
 {
    postfix_t p;
@@ -375,6 +417,103 @@ TEST(test_seq2)
   }
 }
 
+TEST(sequences_are_lazy)
+{
+   postfix_t p;
+   p.push(1e7);
+   p.push("seq1");
+   EQ(10000000, p.top());
+   p.push("sum");
+   EQ(num_t("50000005000000"), p.top());
+   p.push("clear");
+
+   p.push(1e7);
+   p.push("seq1");
+   p.push("avg");
+   EQ(num_t("5000000.5"), p.top());
+   p.push("clear");
+
+   p.push(1e15);
+   p.push("seq0");
+   EQ(num_t("999999999999999"), p.pop());
+   EQ(num_t("999999999999998"), p.pop());
+   p.push("clear");
+
+   // Anything else pushes the values first.
+   p.push(7);
+   p.push(3);
+   p.push("seq1");
+   EQ("7   1   2   3", p.str());
+   p.push(10);
+   p.push("*");
+   EQ("7   1   2   30", p.str());
+   p.push("sum");
+   EQ(40, p.top());
+   p.push("clear");
+
+   // Too many to push: refused, and the sequence stays.
+   p.push(1e12);
+   p.push("seq1");
+   THROW(p.push("neg"), const char*);
+   THROW(p.push(5), const char*);
+   EQ(1000000000000, p.depth());
+   p.push("sum");
+   EQ(num_t("500000000000500000000000"), p.top());
+}
+
+TEST(materialize_cap)
+{
+   using double_postfix_t = basic_postfix_t<double>;
+   double_postfix_t d;
+   d.push(double(double_postfix_t::max_materialize + 1));
+   d.push("seq1");
+   THROW(d.push("neg"), const char*);
+   EQ(double_postfix_t::max_materialize + 1, d.depth());
+   d.push("clear");
+   EQ(0, d.depth());
+
+   using dec50_postfix_t = basic_postfix_t<dec50_t>;
+   dec50_postfix_t f;
+   f.push(dec50_t(dec50_postfix_t::max_materialize + 1));
+   f.push("seq1");
+   THROW(f.push("neg"), const char*);
+   f.push("sum");
+   EQ(dec50_t(dec50_postfix_t::max_materialize + 1) * (dec50_postfix_t::max_materialize + 2) / 2, f.top());
+   f.push("pop");
+   f.push(1000);
+   f.push("seq1");
+   f.push("neg");
+   EQ(dec50_t(-1000), f.top());
+}
+
+TEST(sequence_reductions_include_the_rest)
+{
+   postfix_t p;
+   p.push(100);
+   p.push(4);
+   p.push("seq1");
+   p.push("prod");
+   EQ(2400, p.top());
+   p.push("clear");
+   p.push(-8);
+   p.push(3);
+   p.push("seq1");
+   p.push("stats");
+   EQ(3, p.pop());
+   EQ(-8, p.pop());
+   CL(sqrt(num_t(77) / 3), p.pop(), num_t("1e-1000"));
+   CL(num_t(77) / 3, p.pop(), num_t("1e-1000"));
+   EQ(-0.5, p.pop());
+   EQ(-2, p.pop());
+   EQ(4, p.pop());
+
+   basic_postfix_t<int_t> i;
+   i.push(int_t(30));
+   i.push("seq1");
+   i.push("prod");
+   EQ(int_t("265252859812191058636308480000000"), i.top());
+}
+
 TEST(test_seq3)
 {
   postfix_t p;
@@ -602,6 +741,97 @@ TEST(clear_stack)
    EQ("", p.str());
 }
 
+TEST(com_groups_integer_digits_only)
+{
+   postfix_t p;
+   p.push("com");
+   p.push(-123);
+   p.push("1234567.123456");
+   p.push("-1e30");
+   p.push(".5");
+   p.push("inf");
+   EQ
+   (
+      "-123   1,234,567.123456   -1,000,000,000,000,000,000,000,000,000,000"
+      "   0.5   inf",
+      p.str()
+   );
+
+   EQ
+   (
+      "-1,234,567.5",
+      postfix_t::format(num_t("-1234567.5"), display_types_t::com)
+   );
+
+   p.grouping(commaifier_t(4, '_'));
+   p.push("clr");
+   p.push("-12345678.9");
+   p.push(123);
+   EQ("-1234_5678.9   123", p.str());
+   p.grouping(commaifier_t(0));
+   EQ("-12345678.9   123", p.str());
+
+   p.grouping(commaifier_t(3, '_'));
+   p.push(4);
+   p.push("group");
+   EQ("-1234_5678.9   123", p.str());
+   p.push(0);
+   p.push("group");
+   EQ("-12345678.9   123", p.str());
+   p.push("2.5");
+   THROW(p.push("group"), const char*);
+   p.push("pop");
+   p.push(-1);
+   THROW(p.push("group"), const char*);
+   p.push("pop");
+   EQ(0, p.grouping().group());
+   EQ('_', p.grouping().separator());
+
+   EQ("1e+300", commaifier_t().str("1e+300"));
+   EQ("12,345e+300", commaifier_t().str("12345e+300"));
+}
+
+TEST(display_digits)
+{
+   postfix_t p;
+   p.push(1);
+   p.push(3);
+   p.push("/");
+   EQ(1050, p.str().size());
+   p.push(20);
+   p.push("digits");
+   EQ(20, p.display_digits());
+   EQ("0.33333333333333333333", p.str());
+   p.push("9.96");
+   p.push("-1234567.891");
+   p.push(2);
+   p.push("digits");
+   EQ("0.33   10   -1.2e+06", p.str());
+   p.push("eng");
+   EQ("0.33   10   -1.2e+06", p.str());
+   p.push(7);
+   p.push("digits");
+   p.push("com");
+   EQ("0.3333333   9.96   -1,234,568", p.str());
+   p.push("0");
+   p.push("digits");
+   EQ(1050 + 3 + 4 + 3 + 14, p.str().size());
+
+   p.push("-1");
+   THROW(p.push("digits"), const char*);
+   p.push("pop");
+   p.push("2.5");
+   THROW(p.push("digits"), const char*);
+   EQ(0, p.display_digits());
+
+   basic_postfix_t<double> d;
+   d.push(2);
+   d.push("sqrt");
+   d.push(3);
+   d.push("digits");
+   EQ("1.41", d.str());
+}
+
 TEST(factorial)
 {
    postfix_t p;
@@ -679,6 +909,52 @@ TEST(binary)
    EQ(128+32+4+1, p.top());
 }
 
+TEST(nondecimal_long)
+{
+   postfix_t p;
+   p.push("0x" + std::string(64, 'f'));
+   EQ(pow(num_t(2), 256) - 1, p.top());
+   // 22 octal digits straddle the first limb boundary.
+   p.push("0o" + std::string(22, '7'));
+   EQ(pow(num_t(2), 66) - 1, p.top());
+   p.push("0b1" + std::string(100, '0'));
+   EQ(pow(num_t(2), 100), p.top());
+}
+
+TEST(nondecimal_fraction)
+{
+   postfix_t p;
+   p.push("0o7.4");
+   EQ(7.5, p.top());
+   p.push("0b.011");
+   EQ(0.375, p.top());
+   p.push("0x1." + std::string(40, '0') + "1");
+   // Exactly 1 + 2^-164.
+   EQ
+   (
+      num_t
+      (
+         "1.000000000000000000000000000000000000000000000000042764235361475"
+         "130338248583474423710061043150081680779167390999874566378255794"
+         "08573872797205694951117038726806640625"
+      ),
+      p.top()
+   );
+
+   basic_postfix_t<double> d;
+   d.push("0xdead.beef");
+   EQ(0xdeadbeef / 65536.0, d.top());
+}
+
+TEST(nondecimal_invalid_digit)
+{
+   postfix_t p;
+   THROW(p.push("0o8"), const char*);
+   THROW(p.push("0b102"), const char*);
+   THROW(p.push("0x1.2.3"), const char*);
+   EQ("", p.str());
+}
+
 TEST(sum_list)
 {
    postfix_t p;
@@ -690,6 +966,27 @@ TEST(sum_list)
    EQ(55, p.top());
 }
 
+TEST(reductions_ignore_threads)
+{
+   const std::string reductions[] = {"sum", "prod", "avg"};
+   for (const std::string& reduction : reductions)
+   {
+      std::string results[2];
+      for (std::size_t threads : {1, 4})
+      {
+         postfix_t p;
+         p.threads(threads);
+         for (int i = 1; i <= 20000; ++i)
+         {
+            p.push(num_t(1) / i);
+         }
+         p.push(reduction);
+         results[threads == 4] = p.top().str(0);
+      }
+      EQ(results[0], results[1]);
+   }
+}
+
 TEST(test_pk)
 {
    postfix_t p;
@@ -736,13 +1033,48 @@ TEST(bin_display)
    EQ("0b11111010110011100101", p.str());
 }
 
-TEST(hex_display_null)
+TEST(hex_display_fraction)
 {
    postfix_t p;
    p.push(0.125);
    p.push("hex");
    EQ(0.125, p.top());
-   EQ("0x0", p.str());
+   EQ("0x0.2", p.str());
+   p.push("clear");
+   p.push(0);
+   p.push(-31.5);
+   EQ("0x0   -0x1f.8", p.str());
+}
+
+TEST(radix_display_negative_and_fraction)
+{
+   postfix_t p;
+   p.push(-0.375);
+   p.push(-8);
+   p.push("bin");
+   EQ("-0b0.011   -0b1000", p.str());
+   p.push("oct");
+   EQ("-0o0.3   -0o10", p.str());
+}
+
+TEST(radix_display_large)
+{
+   postfix_t p;
+   p.push(2);
+   p.push(300);
+   p.push("^");
+   p.push("hex");
+   EQ("0x1" + std::string(75, '0'), p.str());
+}
+
+TEST(radix_display_repeating_fraction)
+{
+   basic_postfix_t<double> p;
+   p.push(1);
+   p.push(3);
+   p.push("/");
+   p.push("hex");
+   EQ("0x0.55555555555554", p.str());
 }
 
 TEST(avg_fun)
@@ -768,7 +1100,39 @@ TEST(stddev_fun)
    p.push(7);
    p.push(9);
    p.push("stddev");
-   CL(4.57142857142857142857142857142857, p.top(), 1e-12);
+   CL(sqrt(num_t(32) / 7), p.top(), num_t("1e-1000"));
+   p.clear();
+   p.push("0.5");
+   p.push("1.5");
+   p.push("stddev");
+   CL(sqrt(num_t("0.5")), p.top(), num_t("1e-1000"));
+}
+
+TEST(stats_fun)
+{
+   postfix_t p;
+   p.push(100);
+   p.push("seq1");
+   p.push("stats");
+   EQ(100, p.pop());
+   EQ(1, p.pop());
+   CL(sqrt(num_t(2525) / 3), p.pop(), num_t("1e-1000"));
+   CL(num_t(2525) / 3, p.pop(), num_t("1e-1000"));
+   EQ(num_t("50.5"), p.pop());
+   EQ(5050, p.pop());
+   EQ(100, p.pop());
+   p.push(3);
+   p.push("0.5");
+   p.push(-2);
+   p.push("stats");
+   EQ(3, p.pop());
+   EQ(-2, p.pop());
+   EQ(num_t("2.5"), p.pop());
+   EQ(num_t("6.25"), p.pop());
+   CL(num_t(1) / 2, p.pop(), num_t("1e-1000"));
+   EQ(num_t("1.5"), p.pop());
+   EQ(3, p.pop());
+   THROW(p.push("stats"), const char*);
 }
 
 TEST(removes_commas)
@@ -788,6 +1152,142 @@ TEST(log2_test)
   CL(138.301699036395595, p.top(), 1e-12);
 }
 
+namespace
+{
+   /**
+    * gam, past and log2 must give exactly what they gave
+    * when they ran as these postfix steps.
+    */
+   template <typename number_t>
+   void require_composites_exact()
+   {
+      const std::pair<std::string, std::string> composites[] =
+      {
+         {"gam", "2 ^ c 2 ^ / -1 * 1 + sqrt -1 ^"},
+         {"lor", "2 ^ c 2 ^ / -1 * 1 + sqrt -1 ^"},
+         {"past", "-0.231 * e sw ^ 1.23e15 * 60 *"},
+         {"log2", "log 2 log /"},
+         {"l2", "log 2 log /"},
+      };
+      for (const char* x : {"126", "130.5", "1000", "2.5e7", "299792457"})
+      {
+         for (const auto& composite : composites)
+         {
+            basic_postfix_t<number_t> native;
+            native.push(x);
+            native.push(composite.first);
+
+            basic_postfix_t<number_t> steps;
+            steps.push(x);
+            std::istringstream tokens(composite.second);
+            std::string token;
+            while (tokens >> token)
+            {
+               steps.push(token);
+            }
+            EQ(steps.top(), native.top());
+            EQ(1, native.depth());
+         }
+      }
+   }
+}
+
+TEST(composites_match_their_steps)
+{
+   require_composites_exact<num_t>();
+   require_composites_exact<dec50_t>();
+   require_composites_exact<dec100_t>();
+   require_composites_exact<float128_t>();
+   require_composites_exact<double>();
+
+   postfix_t p;
+   p.push(1);
+   p.push(2);
+   p.push("sw");
+   EQ(1, p.top());
+   p.push("p");
+   EQ(2, p.top());
+   p.push("clr");
+   EQ(0, p.depth());
+}
+
+TEST(definitions)
+{
+   postfix_t p;
+   p.define("sq", "2 ^");
+   p.define("Hyp", "sq sw sq + sqrt");
+   p.push(3);
+   p.push(4);
+   p.push("HYP");
+   EQ(5, p.top());
+   EQ(1, p.depth());
+
+   // Callers see a redefinition.
+   p.define("sq", "1 *");
+   p.clear();
+   p.push(9);
+   p.push(16);
+   p.push("hyp");
+   EQ(5, p.top());
+
+   p.define("sq", "2 ^");
+   auto definitions = p.definitions();
+   BOOST_REQUIRE(definitions.size() == 2);
+   EQ("hyp", definitions[0].first);
+   EQ("sq sw sq + sqrt", definitions[0].second);
+   EQ("sq", definitions[1].first);
+
+   BOOST_REQUIRE(p.defined("SQ"));
+   BOOST_REQUIRE(p.undefine("SQ"));
+   BOOST_REQUIRE(!p.undefine("sq"));
+   BOOST_REQUIRE(!p.defined("sq"));
+   EQ(1, p.definitions().size());
+   THROW(p.push("sq"), const char*);
+   THROW(p.push("hyp"), const char*);
+}
+
+TEST(bad_definitions)
+{
+   postfix_t p;
+   THROW(p.define("sin", "2 *"), const char*);
+   THROW(p.define("0x10", "2 *"), const char*);
+   THROW(p.define("inf", "2 *"), const char*);
+   // Reads as the hexadecimal 0.
+   THROW(p.define("x", "2 *"), const char*);
+   THROW(p.define("twice", "2 frobnicate"), const char*);
+   THROW(p.define("twice", ""), const char*);
+   THROW(p.define("thrice", "twice"), const char*);
+   EQ(0, p.definitions().size());
+
+   // A failed redefinition keeps the old one.
+   p.define("twice", "2 *");
+   THROW(p.define("twice", "frobnicate"), const char*);
+   p.push(21);
+   p.push("twice");
+   EQ(42, p.top());
+}
+
+TEST(recursion_limit)
+{
+   postfix_t p;
+   p.call_limit(4);
+   p.define("up", "1 + up");
+   p.push(0);
+   THROW(p.push("up"), const char*);
+   // Each of the four calls allowed added its 1.
+   EQ(4, p.top());
+
+   // The depth unwinds after a failure.
+   p.define("inc", "1 +");
+   p.push("inc");
+   EQ(5, p.top());
+
+   p.call_limit(256);
+   p.budget().step_limit(100);
+   THROW(p.push("up"), const char*);
+   BOOST_REQUIRE(p.budget().cancelled());
+}
+
 TEST(pressure)
 {
   postfix_t p;
@@ -799,3 +1299,271 @@ TEST(pressure)
   p.push("pr");
   CL(28.2932, p.top(), 1e-4);
 }
+
+TEST(double_backend)
+{
+   basic_postfix_t<double> p;
+   p.push("1.5");
+   p.push(2);
+   p.push("*");
+   EQ(3.0, p.top());
+   p.push("xff");
+   p.push("+");
+   EQ(258.0, p.top());
+   p.push("pi");
+   p.push("cos");
+   EQ(-1.0, p.top());
+   EQ("258   -1", p.str());
+}
+
+TEST(dec50_backend)
+{
+   basic_postfix_t<dec50_t> p;
+   p.push(1);
+   p.push(3);
+   p.push("/");
+   CL(dec50_t("0.33333333333333333333333333333333333333333333333333"),
+      p.top(),
+      1e-45);
+   p.push("hex");
+   p.push(255);
+   EQ("0x0." + std::string(42, '5') + "   0xff", p.str());
+}
+
+TEST(float128_backend)
+{
+   basic_postfix_t<float128_t> p;
+   p.push(2);
+   p.push("sqrt");
+   CL(float128_t("1.41421356237309504880168872420969807857"), p.top(), 1e-30);
+   p.push(10);
+   p.push("!");
+   EQ(3628800, p.top());
+}
+
+namespace
+{
+   /**
+    * The short literal fast path must agree exactly with
+    * number_t's own parse of the same text.
+    */
+   template <typename number_t>
+   void require_short_literals_exact()
+   {
+      const std::pair<std::string, std::string> literals[] =
+      {
+         {"0", "0"},
+         {"7", "7"},
+         {"-12.5", "-12.5"},
+         {".1", ".1"},
+         {"5.", "5."},
+         {"3.14159265358979", "3.14159265358979"},
+         {"0.000000000000000001", "0.000000000000000001"},
+         {"999999999999999999", "999999999999999999"},
+         {"-0.30000000000000001", "-0.30000000000000001"},
+         {"1,234,567.25", "1234567.25"},
+         // Too long for an int64_t: the general path.
+         {"12345678901234567890.5", "12345678901234567890.5"},
+      };
+      for (const auto& literal : literals)
+      {
+         EQ
+         (
+            num_traits_t<number_t>::parse(literal.second),
+            basic_postfix_t<number_t>::parse(literal.first)
+         );
+      }
+   }
+}
+
+TEST(short_literals)
+{
+   require_short_literals_exact<num_t>();
+   require_short_literals_exact<dec50_t>();
+   require_short_literals_exact<float128_t>();
+   require_short_literals_exact<double>();
+
+   postfix_t p;
+   THROW(p.push("1.2.3"), const char*);
+   THROW(p.push(","), const char*);
+   p.push("-0");
+   EQ(0, p.top());
+}
+
+TEST(dec100_backend_matches_default)
+{
+   basic_postfix_t<dec100_t> narrow;
+   postfix_t wide;
+   narrow.push("2");
+   wide.push("2");
+   narrow.push("256");
+   wide.push("256");
+   narrow.push("^");
+   wide.push("^");
+   EQ(narrow.str(), wide.str());
+}
+
+TEST(operator_table)
+{
+   static_assert(op_count > 0, "empty operator table");
+   for (std::size_t i = 0; i < op_count; ++i)
+   {
+      op_t op;
+      std::string name(op_names[i]);
+      BOOST_REQUIRE(find_op(name, op));
+      EQ(i, static_cast<std::size_t>(op));
+      boost::algorithm::to_upper(name);
+      BOOST_REQUIRE(find_op(name, op));
+      EQ(i, static_cast<std::size_t>(op));
+   }
+   op_t op;
+   BOOST_REQUIRE(!find_op("", op));
+   BOOST_REQUIRE(!find_op("1234", op));
+   BOOST_REQUIRE(!find_op("sqr", op));
+   BOOST_REQUIRE(!find_op("sqrtt", op));
+}
+
+TEST(int_backend)
+{
+   basic_postfix_t<int_t> p;
+   p.push("7");
+   p.push("2");
+   p.push("/");
+   EQ(int_t(3), p.top());
+   p.push("-2");
+   p.push("%");
+   EQ(int_t(1), p.top());
+   p.push("0");
+   THROW(p.push("/"), const char*);
+   EQ(int_t(0), p.pop());
+   p.push("0123");
+   EQ(int_t(123), p.pop());
+   THROW(p.push("1.5"), const char*);
+   THROW(p.push("0x1.8"), const char*);
+   p.push("123456789012345678901234567890");
+   EQ(int_t("123456789012345678901234567890"), p.pop());
+   p.push("17");
+   p.push("sqrt");
+   EQ(int_t(4), p.pop());
+   p.push("25");
+   p.push("!");
+   EQ(int_t("15511210043330985984000000"), p.pop());
+}
+
+TEST(int_backend_shifts_and_powers)
+{
+   basic_postfix_t<int_t> p;
+   p.push("1");
+   p.push("200");
+   p.push("<<");
+   EQ(int_t(1) << 200, p.top());
+   p.push("199");
+   p.push(">>");
+   EQ(int_t(2), p.pop());
+   p.push("-5");
+   p.push("1");
+   p.push(">>");
+   EQ(int_t(-3), p.pop());
+   p.push("3");
+   p.push("100");
+   p.push("^");
+   EQ(boost::multiprecision::pow(int_t(3), 100), p.pop());
+   p.push("-1");
+   p.push("1000000000001");
+   p.push("^");
+   EQ(int_t(-1), p.pop());
+   p.push("2");
+   p.push("-1");
+   THROW(p.push("^"), const char*);
+   p.clear();
+   p.push("1");
+   p.push("100000000");
+   THROW(p.push("<<"), const char*);
+}
+
+TEST(int_backend_rejects_fractions)
+{
+   basic_postfix_t<int_t> p;
+   p.push("2");
+   THROW(p.push("sin"), const char*);
+   THROW(p.push("pi"), const char*);
+   THROW(p.push("mf"), const char*);
+   EQ(int_t(2), p.pop());
+   p.push("-3");
+   p.push("floor");
+   p.push("abs");
+   EQ(int_t(3), p.pop());
+}
+
+TEST(int_backend_display)
+{
+   basic_postfix_t<int_t> p;
+   p.push("0xdeadbeefdeadbeefdeadbeef");
+   p.push("hex");
+   EQ("0xdeadbeefdeadbeefdeadbeef", p.str());
+   p.push("com");
+   EQ("68,915,718,021,581,205,938,132,336,367", p.str());
+}
+
+TEST(bitwise)
+{
+   basic_postfix_t<int_t> p;
+   p.push("0xf0f0");
+   p.push("0xff00");
+   p.push("&");
+   EQ(int_t(0xf000), p.top());
+   p.push("0x0f");
+   p.push("|");
+   EQ(int_t(0xf00f), p.top());
+   p.push("0xffff");
+   p.push("^^");
+   EQ(int_t(0x0ff0), p.top());
+   p.push("~");
+   EQ(int_t(-0x0ff1), p.top());
+   p.push("0xff");
+   p.push("&");
+   EQ(int_t(0x0f), p.pop());
+   p.push("0xffffffffffffffffffff");
+   p.push("popcount");
+   EQ(int_t(80), p.pop());
+   p.push("1");
+   p.push("clz");
+   EQ(int_t(63), p.pop());
+   p.push("0");
+   p.push("clz");
+   EQ(int_t(64), p.pop());
+   p.push("1");
+   p.push("64");
+   p.push("<<");
+   p.push("clz");
+   EQ(int_t(63), p.pop());
+   p.push("-1");
+   THROW(p.push("popcount"), const char*);
+}
+
+TEST(bitwise_on_whole_numbers)
+{
+   postfix_t p;
+   p.push("0xf0f0");
+   p.push("0xff00");
+   p.push("&");
+   EQ(0xf000, p.top());
+   p.push("~");
+   EQ(-0xf001, p.top());
+   p.push("-5");
+   p.push("3");
+   p.push("&");
+   EQ(3, p.top());
+   p.push("1.5");
+   THROW(p.push("|"), const char*);
+   EQ(num_t("1.5"), p.pop());
+   p.push("1e300");
+   p.push("popcount");
+   EQ(346, p.pop());
+
+   basic_postfix_t<double> d;
+   d.push("12");
+   d.push("5");
+   d.push("^^");
+   EQ(9, d.top());
+}
@@ -0,0 +1,208 @@
+#include ".test.hpp"
+#include "compiler_t.hpp"
+#include "optimizer_t.hpp"
+#include "rat_t.hpp"
+
+TEST(postfix_program)
+{
+   compiler_t compiler;
+   program_t program = compiler.postfix("1 2 + 3 *");
+   EQ(5, program.size());
+   EQ(9, program.evaluate());
+}
+
+TEST(infix_program)
+{
+   compiler_t compiler;
+   program_t program = compiler.infix("(1+2)*7+2^(4+1)");
+   EQ(53, program.evaluate());
+}
+
+TEST(program_is_reusable)
+{
+   compiler_t compiler;
+   program_t program = compiler.infix("2^8+15*32-14/3");
+   for (int i = 0; i < 3; ++i)
+   {
+      CL(731.33333333333, program.evaluate(), 1e-9);
+   }
+}
+
+TEST(program_matches_engine)
+{
+   const std::string expr = "5! + 2*pi - 0x10 / 0b100";
+   postfix_t p;
+   infix_t infix(p);
+   infix.parse(expr);
+
+   compiler_t compiler;
+   EQ(p.top(), compiler.infix(expr).evaluate());
+}
+
+TEST(program_runs_on_existing_stack)
+{
+   compiler_t compiler;
+   program_t program = compiler.postfix("2 *");
+   postfix_t p;
+   p.push(21);
+   program.run(p);
+   EQ(42, p.top());
+   program.run(p);
+   EQ(84, p.top());
+}
+
+TEST(program_case_insensitive_operators)
+{
+   compiler_t compiler;
+   EQ(-1, compiler.postfix("PI COS").evaluate());
+}
+
+TEST(program_rejects_bad_tokens)
+{
+   compiler_t compiler;
+   THROW(compiler.postfix("1 2 frobnicate"), const char*);
+   THROW(compiler.infix("1 + frobnicate"), const char*);
+   THROW(compiler.infix("1 + 2)"), const char*);
+}
+
+TEST(program_stack_errors_propagate)
+{
+   compiler_t compiler;
+   program_t program = compiler.postfix("+");
+   THROW(program.evaluate(), const char*);
+}
+
+namespace
+{
+   /**
+    * Check that optimizing expr over inputs x and y keeps its
+    * value to the last digit.
+    * @return the optimized program
+    */
+   template <typename number_t>
+   basic_program_t<number_t> same_when_optimized
+   (
+      const std::string& expr,
+      const number_t& x,
+      const number_t& y
+   )
+   {
+      basic_compiler_t<number_t> compiler;
+      basic_program_t<number_t> program = compiler.postfix(expr, {"x", "y"});
+      basic_program_t<number_t> optimized = basic_optimizer_t<number_t>()(program);
+      EQ(program.evaluate({x, y}), optimized.evaluate({x, y}));
+      LE(optimized.size(), program.size());
+      return optimized;
+   }
+}
+
+TEST(optimizer_folds_constants)
+{
+   compiler_t compiler;
+   optimizer_t optimize;
+   program_t program = optimize(compiler.postfix("2 8 ^ x *", {"x"}));
+   EQ(3, program.size());
+   EQ(768, program.evaluate({3}));
+
+   program = optimize(compiler.infix("2*pi*x", {"x"}));
+   EQ(3, program.size());
+   EQ(compiler.infix("2*pi*x", {"x"}).evaluate({5}), program.evaluate({5}));
+
+   // Nothing left to do at run time.
+   EQ(1, optimize(compiler.infix("5! + 2*pi - 0x10 / 0b100")).size());
+}
+
+TEST(optimizer_shares_subexpressions)
+{
+   compiler_t compiler;
+   program_t program = compiler.postfix("x 1 + sin x 1 + sin +", {"x"});
+   program_t optimized = optimizer_t()(program);
+   // x 1 + sin store load +
+   EQ(7, optimized.size());
+   EQ(program.evaluate({2}), optimized.evaluate({2}));
+}
+
+TEST(optimizer_squares)
+{
+   compiler_t compiler;
+   program_t program = optimizer_t()(compiler.infix("x^2 + (x+1)*(x+1)", {"x"}));
+   // x 2 ^ x 1 + square +, the power left as it was
+   EQ(8, program.size());
+   EQ(num_t(3) * 3 + 4 * 4, program.evaluate({3}));
+}
+
+TEST(optimizer_keeps_results)
+{
+   for
+   (
+      const char* expr :
+      {
+         "x 2 ^ y 2 ^ +",
+         "x x * y y * + sqrt x x * y y * + /",
+         "x sin 2 ^ x cos 2 ^ +",
+         "x y + x y - / x y + *",
+         "x 2 ^ 2 ^",
+         "2 0.5 ^ x * 1 3 / y * -",
+         "x ln y * exp x y ^ -",
+         "y x atan2 y x atan2 1e-20 * +",
+         "x y 1 2 3 + + x y - x y - *",
+      }
+   )
+   {
+      same_when_optimized<num_t>(expr, num_t("1.7"), num_t("-0.3"));
+      same_when_optimized<num_t>(expr, 3, 7);
+      same_when_optimized<double>(expr, 1.7, -0.3);
+      same_when_optimized<float128_t>(expr, 3, float128_t("0.1"));
+      same_when_optimized<dec50_t>(expr, dec50_t("1.7"), dec50_t("-0.3"));
+      same_when_optimized<dec100_t>(expr, dec100_t("1.7"), dec100_t("-0.3"));
+      same_when_optimized<rat_t>(expr, rat_t(17, 10), rat_t(-3, 10));
+   }
+}
+
+TEST(optimizer_integer_engine)
+{
+   // The power keeps its size check.
+   basic_program_t<int_t> program = same_when_optimized<int_t>("x 2 ^ x 3 << x 3 << * + 2 100 ^ +", 5, 0);
+   EQ(int_t(5 * 5 + 40 * 40) + (int_t(1) << 100), program.evaluate({5, 0}));
+   THROW(same_when_optimized<int_t>("x y ^", 2, int_t(1) << 70), const char*);
+}
+
+TEST(optimizer_leaves_barriers)
+{
+   compiler_t compiler;
+   optimizer_t optimize;
+
+   // Reaches below what the program pushed.
+   program_t program = optimize(compiler.postfix("2 *"));
+   postfix_t p;
+   p.push(21);
+   program.run(p);
+   EQ(42, p.top());
+
+   // Not pure: the runs on either side are still optimized,
+   // and nothing moves across sum or swap.
+   program = optimize(compiler.postfix("1 2 3 2 2 + sum 3 sw - x x * *", {"x"}));
+   program_t original = compiler.postfix("1 2 3 2 2 + sum 3 sw - x x * *", {"x"});
+   EQ(original.evaluate({4}), program.evaluate({4}));
+   LT(program.size(), original.size());
+
+   THROW(optimize(compiler.postfix("+")).evaluate(), const char*);
+
+   // Optimizing twice changes nothing.
+   program = optimize(compiler.infix("x*x + x*x", {"x"}));
+   EQ(program.size(), optimize(program).size());
+}
+
+TEST(optimizer_slots_reused_across_runs)
+{
+   compiler_t compiler;
+   program_t program = optimizer_t()(compiler.postfix("x 1 + sin x 1 + sin +", {"x"}));
+   std::vector<num_t> slots;
+   for (int x : {1, 2, 3})
+   {
+      postfix_t p;
+      program.run(p, {x}, slots);
+      EQ(program.evaluate({x}), p.top());
+   }
+   EQ(1, slots.size());
+}
@@ -0,0 +1,163 @@
+#include ".test.hpp"
+#include "rat_t.hpp"
+#include "postfix_t.hpp"
+
+namespace
+{
+   void push(basic_postfix_t<rat_t>& p, const std::string& line)
+   {
+      std::istringstream tokens(line);
+      std::string token;
+      while (tokens >> token)
+      {
+         p.push(token);
+      }
+   }
+}
+
+TEST(exact_thirds)
+{
+   rat_t third = rat_t(1) / 3;
+   EQ(rat_t(1), third * 3);
+   EQ(rat_t(1), third + third + third);
+   NE(rat_t(1), rat_t(1) / 3 + rat_t(2) / 3 + rat_t(1) / 1000000);
+}
+
+TEST(parse)
+{
+   EQ(rat_t(45359237, 100000000), rat_t("0.45359237"));
+   EQ(rat_t(-22, 7), rat_t("-22/7"));
+   EQ(rat_t(6022140, 1) * 100000000000000000LL, rat_t("6.02214e23"));
+   EQ(rat_t(1, 1000), rat_t("1e-3"));
+   EQ(rat_t(7), rat_t("007"));
+   THROW(rat_t("1/0"), const char*);
+   THROW(rat_t("1.2.3"), std::runtime_error);
+}
+
+TEST(reduced_when_read)
+{
+   rat_t r(6, 8);
+   EQ(int_t(3), r.numerator());
+   EQ(int_t(4), r.denominator());
+   EQ(rat_t(1, 2), rat_t(-1, -2));
+   EQ(int_t(-1), rat_t(1, -2).numerator());
+}
+
+TEST(division_by_zero)
+{
+   THROW(rat_t(1) / rat_t(0), const char*);
+   THROW(rat_t(1, 0), const char*);
+}
+
+TEST(rounding)
+{
+   EQ(rat_t(2), round(rat_t(3, 2)));
+   EQ(rat_t(-2), round(rat_t(-3, 2)));
+   EQ(rat_t(1), floor(rat_t(3, 2)));
+   EQ(rat_t(-2), floor(rat_t(-3, 2)));
+   EQ(rat_t(2), ceil(rat_t(3, 2)));
+   EQ(rat_t(-1), trunc(rat_t(-3, 2)));
+   EQ(rat_t(1, 6), fmod(rat_t(3, 2), rat_t(1, 3)));
+}
+
+TEST(frexp_ldexp)
+{
+   int exponent = 0;
+   rat_t fraction = frexp(rat_t(12), &exponent);
+   EQ(rat_t(3, 4), fraction);
+   EQ(4, exponent);
+   EQ(rat_t(12), ldexp(fraction, exponent));
+   EQ(rat_t(1, 8), ldexp(rat_t(1), -3));
+}
+
+TEST(sqrt_and_pow)
+{
+   EQ(rat_t(2, 3), sqrt(rat_t(4, 9)));
+   EQ(rat_t(1, 8), pow(rat_t(2), rat_t(-3)));
+   EQ(rat_t(27, 8), pow(rat_t(3, 2), rat_t(3)));
+   CL(sqrt(num_t(2)), sqrt(rat_t(2)).decimal(), num_t("1e-1000"));
+}
+
+TEST(huge_powers)
+{
+   THROW(pow(rat_t(3), rat_t(300000000)), const char*);
+   THROW(pow(rat_t(1, 3), rat_t(-300000000)), const char*);
+   EQ(rat_t(1), pow(rat_t(-1), rat_t(300000000)));
+   EQ(rat_t(0), pow(rat_t(0), rat_t(300000000)));
+
+   basic_postfix_t<rat_t> p;
+   push(p, "3 300000000");
+   THROW(p.push("^"), const char*);
+   EQ(rat_t(300000000), p.pop());
+   EQ(rat_t(3), p.pop());
+}
+
+TEST(huge_shifts)
+{
+   THROW(ldexp(rat_t(1), 2000000000), const char*);
+   THROW(ldexp(rat_t(1), -2000000000), const char*);
+   EQ(rat_t(0), ldexp(rat_t(0), 2000000000));
+
+   basic_postfix_t<rat_t> p;
+   push(p, "1 2000000000");
+   THROW(p.push("<<"), const char*);
+   THROW(p.push(">>"), const char*);
+   EQ(rat_t(2000000000), p.pop());
+   EQ(rat_t(1), p.pop());
+   push(p, "3 1000 <<");
+   EQ(ldexp(rat_t(3), 1000), p.pop());
+}
+
+TEST(past_below_126)
+{
+   basic_postfix_t<rat_t> p;
+   push(p, "125");
+   THROW(p.push("past"), const char*);
+   EQ(rat_t(125), p.pop());
+   push(p, "140 past");
+   CL(num_t(11 * 60), p.pop().decimal(), num_t(1));
+}
+
+TEST(postfix_exact)
+{
+   basic_postfix_t<rat_t> p;
+   push(p, "1 3 / 3 *");
+   EQ(rat_t(1), p.pop());
+   push(p, "1000 mf");
+   EQ(rat_t(1250000, 381), p.pop());
+   push(p, "25 !");
+   EQ(rat_t(int_t("15511210043330985984000000")), p.pop());
+   push(p, "0.1 0.2 +");
+   EQ(rat_t(3, 10), p.pop());
+}
+
+TEST(postfix_errors_restore_stack)
+{
+   basic_postfix_t<rat_t> p;
+   p.push(-1);
+   THROW(p.push("!"), const char*);
+   EQ(rat_t(-1), p.pop());
+   p.push(1);
+   p.push(0);
+   THROW(p.push("/"), const char*);
+   EQ(rat_t(0), p.pop());
+   EQ(rat_t(1), p.pop());
+}
+
+TEST(postfix_transcendental)
+{
+   basic_postfix_t<rat_t> p;
+   push(p, "1 sin");
+   CL(sin(num_t(1)), p.pop().decimal(), num_t("1e-1000"));
+   p.push("pi");
+   EQ(rat_t(constants_t<num_t>::pi()), p.pop());
+}
+
+TEST(postfix_display)
+{
+   basic_postfix_t<rat_t> p;
+   push(p, "255 hex");
+   EQ("0xff", p.str());
+   push(p, "dec pop 1 4 /");
+   EQ("0.25", p.str());
+}
@@ -0,0 +1,70 @@
+#include <vector>
+#include ".test.hpp"
+#include "sequence_t.hpp"
+#include "tree_t.hpp"
+#include "rat_t.hpp"
+
+TEST(between)
+{
+   sequence_t<num_t> s = sequence_t<num_t>::between(1, 1, 10);
+   EQ(10, s.size());
+   EQ(1, s[0]);
+   EQ(10, s.back());
+   s.pop_back();
+   EQ(9, s.back());
+
+   EQ(1, sequence_t<num_t>::between(3, 1, 3).size());
+   EQ(0, sequence_t<num_t>::between(4, 1, 3).size());
+   EQ(3, sequence_t<num_t>::between(1, 1, num_t("3.9")).size());
+   EQ(0, sequence_t<num_t>::between(1, 1, num_t("nan")).size());
+   THROW(sequence_t<num_t>::between(1, 1, num_t("1e100")), const char*);
+}
+
+TEST(fractional_steps)
+{
+   // A third doesn't divide 1 exactly in any decimal, but
+   // the values decide how many there are.
+   const num_t third = num_t(1) / 3;
+   sequence_t<num_t> s = sequence_t<num_t>::between(0, third, 1);
+   LE(s.back(), num_t(1));
+   GT(s[s.size()], num_t(1));
+
+   sequence_t<double> tenths = sequence_t<double>::between(0, 0.1, 1);
+   EQ(11, tenths.size());
+   EQ(0.5, tenths[5]);
+}
+
+TEST(closed_form_sum)
+{
+   EQ(num_t(0), sequence_t<num_t>().sum());
+   EQ(5050, sequence_t<num_t>::between(1, 1, 100).sum());
+   EQ(num_t("50000005000000"), sequence_t<num_t>::between(1, 1, 10000000).sum());
+   EQ(num_t("7.5"), sequence_t<num_t>::between(num_t("0.5"), num_t("0.5"), 2.5).sum());
+   EQ(int_t(-5), sequence_t<int_t>::between(-5, 1, 4).sum());
+   EQ(rat_t(5, 2), sequence_t<rat_t>::between(0, rat_t(1, 3), 1).sum() + rat_t(1, 2));
+
+   sequence_t<num_t> s = sequence_t<num_t>::between(-7, 3, 50);
+   num_t streamed = 0;
+   for (const num_t n : s)
+   {
+      streamed += n;
+   }
+   EQ(streamed, s.sum());
+}
+
+TEST(tree_over_values)
+{
+   sequence_t<int_t> s = sequence_t<int_t>::between(1, 1, 30);
+   budget_t budget;
+   budget_t::scope_t scope(budget);
+   int_t product = tree_t<int_t>(budget)
+   (
+      s.begin(),
+      s.end(),
+      [](int_t& lhs, const int_t& rhs)
+      {
+         lhs *= rhs;
+      }
+   );
+   EQ(int_t("265252859812191058636308480000000"), product);
+}
@@ -0,0 +1,133 @@
+#include ".test.hpp"
+#include "stack_view_t.hpp"
+
+namespace
+{
+   std::string render(stack_view_t& view, postfix_t& p)
+   {
+      std::stringstream ss;
+      view.render(ss, p);
+      return ss.str();
+   }
+}
+
+TEST(shallow_stack_shows_everything)
+{
+   postfix_t p;
+   stack_view_t view(4);
+   EQ("", render(view, p));
+   p.push(1);
+   p.push(2);
+   EQ("1   2", render(view, p));
+   EQ(p.str(), render(view, p));
+}
+
+TEST(deep_stack_shows_window_and_depth)
+{
+   postfix_t p;
+   stack_view_t view(3);
+   p.push(10);
+   p.push("seq1");
+   EQ("(10) ...   8   9   10", render(view, p));
+   view.window(0);
+   EQ(p.str(), render(view, p));
+}
+
+TEST(only_changed_entries_are_rendered)
+{
+   postfix_t p;
+   stack_view_t view(5);
+   p.push(1000);
+   p.push("seq1");
+   render(view, p);
+   EQ(5, view.rendered());
+   render(view, p);
+   EQ(0, view.rendered());
+
+   p.push(2);
+   EQ("(1001) ...   997   998   999   1000   2", render(view, p));
+   EQ(1, view.rendered());
+
+   p.push("*");
+   EQ("(1000) ...   996   997   998   999   2000", render(view, p));
+   EQ(1, view.rendered());
+
+   p.push("swap");
+   EQ("(1000) ...   996   997   998   2000   999", render(view, p));
+   EQ(2, view.rendered());
+}
+
+TEST(modes_are_cached_separately)
+{
+   postfix_t p;
+   stack_view_t view(4);
+   p.push(255);
+   p.push(16);
+   EQ("255   16", render(view, p));
+   p.push("hex");
+   EQ("0xff   0x10", render(view, p));
+   EQ(2, view.rendered());
+   p.push("dec");
+   EQ("255   16", render(view, p));
+   EQ(0, view.rendered());
+   p.push("++");
+   p.push("hex");
+   EQ("0xff   0x11", render(view, p));
+   EQ(1, view.rendered());
+}
+
+TEST(clear_and_sequences)
+{
+   postfix_t p;
+   stack_view_t view(4);
+   p.push(3);
+   p.push("seq1");
+   EQ("1   2   3", render(view, p));
+   p.push("clear");
+   p.push(7);
+   EQ("7", render(view, p));
+   p.push(2);
+   p.push("seq0");
+   EQ("7   0   1", render(view, p));
+   EQ(2, view.rendered());
+}
+
+TEST(grouping_change)
+{
+   postfix_t p;
+   stack_view_t view;
+   p.push(1234567);
+   p.push("com");
+   EQ("1,234,567", render(view, p));
+   p.grouping(commaifier_t(4, '_'));
+   EQ("123_4567", render(view, p));
+   EQ(1, view.rendered());
+}
+
+TEST(digits_change)
+{
+   postfix_t p;
+   stack_view_t view;
+   p.push(2);
+   p.push("sqrt");
+   p.push(3);
+   p.push("digits");
+   EQ("1.41", render(view, p));
+   p.push(5);
+   p.push("digits");
+   EQ("1.4142", render(view, p));
+   EQ(1, view.rendered());
+}
+
+TEST(pending_sequence)
+{
+   postfix_t p;
+   stack_view_t view(3);
+   p.push(1e12);
+   p.push("seq1");
+   EQ("(1000000000000) ...   999999999998   999999999999   1000000000000", render(view, p));
+   EQ(3, view.rendered());
+   p.push("pop");
+   EQ("(999999999999) ...   999999999997   999999999998   999999999999", render(view, p));
+   EQ(1, view.rendered());
+}
@@ -0,0 +1,87 @@
+#include ".test.hpp"
+#include "num_t.hpp"
+#include "rat_t.hpp"
+#include "stats_t.hpp"
+
+TEST(empty_and_single)
+{
+   stats_t<num_t> s;
+   EQ(0u, s.count());
+   EQ(0, s.sum());
+   EQ(0, s.mean());
+   EQ(0, s.variance());
+   s.add(num_t("2.5"));
+   EQ(1u, s.count());
+   EQ(num_t("2.5"), s.mean());
+   EQ(0, s.variance());
+   EQ(num_t("2.5"), s.min());
+   EQ(num_t("2.5"), s.max());
+}
+
+TEST(integers_are_exact)
+{
+   stats_t<num_t> s;
+   for (int i = 1; i <= 1000; ++i)
+   {
+      s.add(i);
+   }
+   EQ(500500, s.sum());
+   EQ(num_t("500.5"), s.mean());
+   CL(num_t(250250) / 3, s.variance(), num_t("1e-1000"));
+   EQ(1, s.min());
+   EQ(1000, s.max());
+}
+
+TEST(integers_then_fractions)
+{
+   // The exact totals carry over to Welford's when the first
+   // fraction arrives.
+   stats_t<dec100_t> mixed;
+   stats_t<dec100_t> fractions;
+   const dec100_t values[] = {4, -7, 12, dec100_t("0.25"), 3, dec100_t(1) / 3};
+   for (const dec100_t& value : values)
+   {
+      mixed.add(value);
+      fractions.add(value + dec100_t("0.5"));
+   }
+   CL(fractions.mean() - dec100_t("0.5"), mixed.mean(), dec100_t("1e-90"));
+   CL(fractions.variance(), mixed.variance(), dec100_t("1e-90"));
+   CL(fractions.sum() - 3, mixed.sum(), dec100_t("1e-90"));
+   EQ(dec100_t(-7), mixed.min());
+   EQ(dec100_t(12), mixed.max());
+}
+
+TEST(stable_for_large_close_values)
+{
+   // Summing x and x^2 in double loses every digit of this
+   // variance.
+   stats_t<double> s;
+   const double offset = 1e9;
+   const double values[] = {4.5, 7.5, 13.5, 16.5};
+   for (double value : values)
+   {
+      s.add(offset + value);
+   }
+   CL(30.0, s.variance(), 1e-6);
+   CL(std::sqrt(30.0), s.stddev(), 1e-6);
+}
+
+TEST(large_integers_leave_exact)
+{
+   stats_t<num_t> s;
+   s.add(num_t("1e30"));
+   s.add(num_t("1e30") + 2);
+   EQ(num_t("1e30") + 1, s.mean());
+   EQ(2, s.variance());
+}
+
+TEST(rationals)
+{
+   stats_t<rat_t> s;
+   s.add(rat_t(1, 3));
+   s.add(rat_t(2, 3));
+   s.add(rat_t(1));
+   EQ(rat_t(2), s.sum());
+   EQ(rat_t(2, 3), s.mean());
+   EQ(rat_t(1, 9), s.variance());
+}
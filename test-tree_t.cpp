@@ -0,0 +1,112 @@
+#include <thread>
+#include <vector>
+#include ".test.hpp"
+#include "tree_t.hpp"
+#include "num_t.hpp"
+
+namespace
+{
+   void add(double& lhs, double rhs)
+   {
+      lhs += rhs;
+   }
+
+   /**
+    * @return the sum of 1/i for i in [1, n] with threads
+    * threads, in doubles so that the order of the additions
+    * shows in the result.
+    */
+   double harmonic(std::size_t n, std::size_t threads)
+   {
+      std::vector<double> values;
+      for (std::size_t i = 1; i <= n; ++i)
+      {
+         values.push_back(1.0 / i);
+      }
+      budget_t budget;
+      budget_t::scope_t scope(budget);
+      return tree_t<double>(budget, threads)(values.begin(), values.end(), add);
+   }
+}
+
+TEST(small_ranges)
+{
+   budget_t budget;
+   budget_t::scope_t scope(budget);
+   tree_t<double> tree(budget);
+   const std::vector<double> values = {1, 2, 3, 4, 5};
+   EQ(1, tree(values.begin(), values.begin() + 1, add));
+   EQ(3, tree(values.begin(), values.begin() + 2, add));
+   EQ(15, tree(values.begin(), values.end(), add));
+}
+
+TEST(same_for_any_thread_count)
+{
+   const std::size_t n = 10 * tree_t<double>::grain + 7;
+   const double serial = harmonic(n, 1);
+   for (std::size_t threads : {2, 3, 4, 7, 16})
+   {
+      // Not CL: the sums must match to the last bit.
+      EQ(serial, harmonic(n, threads));
+   }
+}
+
+TEST(balanced_product_is_exact)
+{
+   std::vector<int_t> values;
+   int_t expected = 1;
+   for (int i = 1; i <= 3 * static_cast<int>(tree_t<int_t>::grain); ++i)
+   {
+      values.emplace_back(i);
+      expected *= i;
+   }
+   budget_t budget;
+   budget_t::scope_t scope(budget);
+   int_t product = tree_t<int_t>(budget, 4)
+   (
+      values.begin(),
+      values.end(),
+      [](int_t& lhs, const int_t& rhs)
+      {
+         lhs *= rhs;
+      }
+   );
+   EQ(expected, product);
+}
+
+TEST(charged_up_front)
+{
+   std::vector<double> values(100, 1.0);
+   budget_t budget;
+   budget.step_limit(99);
+   budget_t::scope_t scope(budget);
+   tree_t<double> tree(budget);
+   THROW(tree(values.begin(), values.end(), add), const char*);
+   BOOST_REQUIRE(budget.cancelled());
+}
+
+TEST(cancelled_while_running)
+{
+   std::vector<double> values(100 * tree_t<double>::grain, 1.0);
+   budget_t budget;
+   budget_t::scope_t scope(budget);
+   std::size_t calls = 0;
+   THROW
+   (
+      tree_t<double>(budget, 1)
+      (
+         values.begin(),
+         values.end(),
+         [&budget, &calls](double& lhs, double rhs)
+         {
+            if (++calls == 1000)
+            {
+               budget.cancel();
+            }
+            lhs += rhs;
+         }
+      ),
+      const char*
+   );
+   LT(calls, values.size() / 2);
+}
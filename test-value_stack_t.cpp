@@ -0,0 +1,108 @@
+#include ".test.hpp"
+#include "value_stack_t.hpp"
+
+TEST(push_pop)
+{
+   value_stack_t<int> s;
+   BOOST_REQUIRE(s.empty());
+   s.push(1);
+   s.push(2);
+   s.push(3);
+   EQ(3, s.size());
+   EQ(3, s.top());
+   EQ(2, s.top(1));
+   EQ(1, s.top(2));
+   EQ(3, s.pop());
+   EQ(2, s.pop());
+   EQ(1, s.pop());
+   BOOST_REQUIRE(s.empty());
+   THROW(s.pop(), const char*);
+   THROW(s.top(), const char*);
+}
+
+TEST(top_in_place)
+{
+   value_stack_t<int> s;
+   s.push(20);
+   s.push(22);
+   s.top(1) += s.top();
+   s.drop();
+   EQ(1, s.size());
+   EQ(42, s.top());
+   THROW(s.drop(2), const char*);
+}
+
+TEST(iterates_bottom_to_top)
+{
+   value_stack_t<int> s;
+   for (int i = 0; i < 5; ++i)
+   {
+      s.push(i);
+   }
+   s.drop(2);
+   std::vector<int> seen(s.begin(), s.end());
+   EQ(3, seen.size());
+   EQ(0, seen[0]);
+   EQ(2, seen[2]);
+}
+
+TEST(arena_stops_growing)
+{
+   value_stack_t<std::string> s(4);
+   const std::string big(1000, 'x');
+   for (int i = 0; i < 100; ++i)
+   {
+      s.push(big);
+   }
+   const std::size_t capacity = s.capacity();
+   const std::string* slot = &s.top(99);
+
+   for (int round = 0; round < 10; ++round)
+   {
+      s.clear();
+      for (int i = 0; i < 100; ++i)
+      {
+         s.push(big);
+      }
+      EQ(capacity, s.capacity());
+      EQ(slot, &s.top(99));
+   }
+}
+
+TEST(shrink_to_fit_releases_unused_slots)
+{
+   value_stack_t<int> s(1000);
+   s.push(1);
+   s.shrink_to_fit();
+   LT(s.capacity(), 1000);
+   EQ(1, s.top());
+}
+
+TEST(tracks_unchanged_bottom)
+{
+   value_stack_t<int> s;
+   for (int i = 0; i < 10; ++i)
+   {
+      s.push(i);
+   }
+   EQ(0, s.unchanged());
+   s.mark_unchanged();
+   EQ(10, s.unchanged());
+   const value_stack_t<int>& view = s;
+   EQ(9, view.top());
+   EQ(10, s.unchanged());
+   s.top(2) = 42;
+   EQ(7, s.unchanged());
+   s.drop(4);
+   EQ(6, s.unchanged());
+   s.push(5);
+   EQ(6, s.unchanged());
+   s.mark_unchanged();
+   s.erase(1, 2);
+   EQ(5, s.size());
+   EQ(5, view.top());
+   EQ(3, view.top(1));
+   EQ(4, s.unchanged());
+   s.clear();
+   EQ(0, s.unchanged());
+}
@@ -0,0 +1,174 @@
+#ifndef __tree_t_hpp__
+#define __tree_t_hpp__
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "budget_t.hpp"
+#include "pool_t.hpp"
+
+/**
+ * Folds a range with an associative operator as a balanced
+ * pairwise tree: each half of the range is folded and the two
+ * results are combined.
+ *
+ * Unlike a left fold, every combination is between operands
+ * of similar size, which is what makes the product of many
+ * large integers cheap, and the rounding error of a sum grows
+ * with the depth of the tree rather than with its length.
+ *
+ * The shape of the tree depends only on the length of the
+ * range. The top of the tree is cut into at most one whole
+ * subtree per thread, the subtrees are folded by the shared
+ * pool_t and their results are combined in the tree's order,
+ * so the result, rounding included, is the same however many
+ * threads share the work.
+ */
+template <typename number_t>
+struct tree_t
+{
+   // Below this many values a subtree isn't worth a thread.
+   static constexpr std::size_t grain = 4096;
+
+   /**
+    * @param[in] threads the most threads to fold with, the
+    * caller's included; 0 for one per core. No more run than
+    * the pool has workers, plus the caller.
+    */
+   explicit tree_t(budget_t& budget, std::size_t threads = 0)
+      :budget_(budget)
+      ,threads_(threads != 0 ? threads : pool_t::cores())
+   {
+   }
+
+   /**
+    * The budget is charged once per value up front, on the
+    * calling thread. While the fold runs every thread checks
+    * it for cancellation and for the deadline.
+    *
+    * @param[in] combine called as combine(number_t& lhs, const
+    * number_t& rhs), it leaves lhs op rhs in lhs
+    * @return the fold of the non-empty range [first, last)
+    */
+   template <typename iterator_t, typename function_t>
+   number_t operator()(iterator_t first, iterator_t last, function_t combine)
+   {
+      budget_.charge(static_cast<std::size_t>(std::distance(first, last)));
+      std::vector<std::pair<iterator_t, iterator_t>> subtrees;
+      split(first, last, threads_, subtrees);
+      if (subtrees.size() == 1)
+      {
+         std::size_t steps = 0;
+         return serial(first, last, combine, steps);
+      }
+      std::vector<number_t> results(subtrees.size());
+      pool_t::shared().run
+      (
+         subtrees.size(),
+         subtrees.size() - 1,
+         [&](std::size_t i)
+         {
+            std::size_t steps = 0;
+            results[i] = serial(subtrees[i].first, subtrees[i].second, combine, steps);
+         }
+      );
+      std::size_t next = 0;
+      return gather(first, last, combine, threads_, results, next);
+   }
+
+private:
+   // How many combinations to make between looks at the
+   // budget.
+   static constexpr std::size_t stride = 64;
+
+   /**
+    * @return true when a subtree of size values shared by
+    * threads threads is folded by one of them.
+    */
+   static bool whole(std::size_t size, std::size_t threads)
+   {
+      return threads < 2 || size < 2 * grain;
+   }
+
+   /**
+    * Cut [first, last) into the subtrees the threads fold,
+    * left to right. The left half gets threads / 2 of the
+    * threads and the right half the rest.
+    */
+   template <typename iterator_t>
+   static void split
+   (
+      iterator_t first,
+      iterator_t last,
+      std::size_t threads,
+      std::vector<std::pair<iterator_t, iterator_t>>& subtrees
+   )
+   {
+      const std::size_t size = static_cast<std::size_t>(std::distance(first, last));
+      if (whole(size, threads))
+      {
+         subtrees.emplace_back(first, last);
+         return;
+      }
+      iterator_t middle = std::next(first, size / 2);
+      split(first, middle, threads / 2, subtrees);
+      split(middle, last, threads - threads / 2, subtrees);
+   }
+
+   /**
+    * Combine the subtrees' results the way split() cut them.
+    */
+   template <typename iterator_t, typename function_t>
+   static number_t gather
+   (
+      iterator_t first,
+      iterator_t last,
+      function_t& combine,
+      std::size_t threads,
+      std::vector<number_t>& results,
+      std::size_t& next
+   )
+   {
+      const std::size_t size = static_cast<std::size_t>(std::distance(first, last));
+      if (whole(size, threads))
+      {
+         return std::move(results[next++]);
+      }
+      iterator_t middle = std::next(first, size / 2);
+      number_t result = gather(first, middle, combine, threads / 2, results, next);
+      number_t right = gather(middle, last, combine, threads - threads / 2, results, next);
+      combine(result, right);
+      return result;
+   }
+
+   template <typename iterator_t, typename function_t>
+   number_t serial
+   (
+      iterator_t first,
+      iterator_t last,
+      function_t& combine,
+      std::size_t& steps
+   )
+   {
+      const std::size_t size = static_cast<std::size_t>(std::distance(first, last));
+      if (size == 1)
+      {
+         return *first;
+      }
+      iterator_t middle = std::next(first, size / 2);
+      number_t result = serial(first, middle, combine, steps);
+      number_t right = serial(middle, last, combine, steps);
+      if (++steps % stride == 0)
+      {
+         budget_.check();
+      }
+      combine(result, right);
+      return result;
+   }
+
+   budget_t& budget_;
+   std::size_t threads_;
+};
+
+#endif
@@ -0,0 +1,213 @@
+#ifndef __value_stack_t_hpp__
+#define __value_stack_t_hpp__
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "debug.hpp"
+
+/**
+ * A value stack backed by one contiguous, reusable arena.
+ * Popping does not destroy the slot; the object stays alive
+ * in the arena and is assigned over by the next push, so a
+ * value type that owns memory keeps it. Once a session has
+ * reached its deepest stack the arena stops growing and
+ * pushing and popping stop touching the allocator.
+ *
+ * The stack also remembers how much of its bottom is
+ * unchanged since mark_unchanged() was last called, so a
+ * display can re-render only what moved. Handing out a
+ * mutable reference or iterator counts as a change.
+ */
+template <typename value_t>
+struct value_stack_t
+{
+   using iterator = typename std::vector<value_t>::iterator;
+   using const_iterator = typename std::vector<value_t>::const_iterator;
+
+   /**
+    * @param[in] capacity the number of slots to preallocate
+    */
+   explicit value_stack_t(std::size_t capacity = 64)
+      :size_(0)
+      ,unchanged_(0)
+   {
+      slots_.reserve(capacity);
+   }
+
+   void push(const value_t& value)
+   {
+      changed(size_);
+      if (size_ < slots_.size())
+      {
+         slots_[size_] = value;
+      }
+      else
+      {
+         slots_.push_back(value);
+      }
+      ++size_;
+   }
+
+   void push(value_t&& value)
+   {
+      changed(size_);
+      if (size_ < slots_.size())
+      {
+         slots_[size_] = std::move(value);
+      }
+      else
+      {
+         slots_.push_back(std::move(value));
+      }
+      ++size_;
+   }
+
+   /**
+    * Remove the top of the stack and return it.
+    */
+   value_t pop()
+   {
+      ensure(size_ > 0);
+      --size_;
+      changed(size_);
+      return std::move(slots_[size_]);
+   }
+
+   /**
+    * Remove values from the top of the stack without
+    * returning them.
+    */
+   void drop(std::size_t count = 1)
+   {
+      ensure(count <= size_);
+      size_ -= count;
+      changed(size_);
+   }
+
+   /**
+    * Remove values from the middle of the stack.
+    * @param[in] depth how far below the top the highest value
+    * to remove is, 0 is the top
+    * @param[in] count how many values to remove, going down
+    */
+   void erase(std::size_t depth, std::size_t count)
+   {
+      ensure(depth + count <= size_);
+      std::size_t first = size_ - depth - count;
+      std::move
+      (
+         slots_.begin() + (first + count),
+         slots_.begin() + size_,
+         slots_.begin() + first
+      );
+      size_ -= count;
+      changed(first);
+   }
+
+   /**
+    * @param[in] depth how far below the top, 0 is the top
+    * @return the slot in place so it can be updated without
+    * a pop and push.
+    */
+   value_t& top(std::size_t depth = 0)
+   {
+      ensure(depth < size_);
+      changed(size_ - 1 - depth);
+      return slots_[size_ - 1 - depth];
+   }
+
+   const value_t& top(std::size_t depth = 0) const
+   {
+      ensure(depth < size_);
+      return slots_[size_ - 1 - depth];
+   }
+
+   std::size_t size() const
+   {
+      return size_;
+   }
+
+   bool empty() const
+   {
+      return size_ == 0;
+   }
+
+   /**
+    * @return the number of slots available before the arena
+    * has to grow.
+    */
+   std::size_t capacity() const
+   {
+      return slots_.capacity();
+   }
+
+   /**
+    * Empty the stack but keep the arena for reuse.
+    */
+   void clear()
+   {
+      size_ = 0;
+      unchanged_ = 0;
+   }
+
+   /**
+    * @return how many values at the bottom of the stack have
+    * not changed since the last call to mark_unchanged().
+    */
+   std::size_t unchanged() const
+   {
+      return unchanged_;
+   }
+
+   void mark_unchanged()
+   {
+      unchanged_ = size_;
+   }
+
+   /**
+    * Count only the bottom count values as unchanged, for
+    * when the ones above them were replaced by equal values.
+    */
+   void mark_unchanged(std::size_t count)
+   {
+      unchanged_ = std::min(count, size_);
+   }
+
+   /**
+    * Give back the slots above the current depth.
+    */
+   void shrink_to_fit()
+   {
+      slots_.resize(size_);
+      slots_.shrink_to_fit();
+   }
+
+   void reserve(std::size_t capacity)
+   {
+      slots_.reserve(capacity);
+   }
+
+   iterator begin() { changed(0); return slots_.begin(); }
+   iterator end() { changed(0); return slots_.begin() + size_; }
+   const_iterator begin() const { return slots_.begin(); }
+   const_iterator end() const { return slots_.begin() + size_; }
+
+private:
+   void changed(std::size_t index)
+   {
+      if (index < unchanged_)
+      {
+         unchanged_ = index;
+      }
+   }
+
+   // slots_[0, size_) is the stack. slots_[size_,
+   // slots_.size()) are live objects waiting to be reused.
+   std::vector<value_t> slots_;
+   std::size_t size_;
+   std::size_t unchanged_;
+};
+
+#endif